@@ -0,0 +1,193 @@
+#include "Commandlets/VoxelBakeCommandlet.h"
+#include "../VoxelTerrain/Generation/VoxelGenerator.h"
+#include "../VoxelTerrain/Generation/VoxelNoiseTileCache.h"
+#include "../VoxelTerrain/Storage/VoxelBakedWorld.h"
+#include "../VoxelTerrain/Storage/VoxelRegionStore.h"
+#include "../VoxelTerrain/World/ChunkManager.h"
+#include "../Structs/VoxelChunkBuffer.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include <atomic>
+
+UVoxelBakeCommandlet::UVoxelBakeCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UVoxelBakeCommandlet::Main(const FString& Params)
+{
+	int32 Seed = 1337;
+	int32 MinX = -8;
+	int32 MinY = -8;
+	int32 MaxX = 7;
+	int32 MaxY = 7;
+	int32 BlockSize = 100;
+	int32 Width = 32;
+	int32 Height = 32;
+	int32 NoiseCacheMB = 256;
+	FString Format = TEXT("Baked");
+	FString Out;
+	FString ChunkManagerPath;
+	FVoxelGeneratorParams BakeParams = GeneratorParams;
+
+	//The manager placed in a level knows exactly what the game generates
+	if (FParse::Value(*Params, TEXT("ChunkManager="), ChunkManagerPath))
+	{
+		const AChunkManager* ChunkManager = LoadObject<AChunkManager>(nullptr, *ChunkManagerPath);
+		if (!ChunkManager)
+		{
+			UE_LOG(LogTemp, Error, TEXT("VoxelBake: could not load chunk manager %s"), *ChunkManagerPath);
+			return 1;
+		}
+
+		BakeParams = ChunkManager->GeneratorParams;
+		Seed = ChunkManager->Seed;
+		BlockSize = ChunkManager->BlockSize;
+		Width = ChunkManager->ChunkWidth;
+		Height = ChunkManager->ChunkHeight;
+	}
+
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("MinX="), MinX);
+	FParse::Value(*Params, TEXT("MinY="), MinY);
+	FParse::Value(*Params, TEXT("MaxX="), MaxX);
+	FParse::Value(*Params, TEXT("MaxY="), MaxY);
+	FParse::Value(*Params, TEXT("BlockSize="), BlockSize);
+	FParse::Value(*Params, TEXT("Width="), Width);
+	FParse::Value(*Params, TEXT("Height="), Height);
+	FParse::Value(*Params, TEXT("NoiseCacheMB="), NoiseCacheMB);
+	FParse::Value(*Params, TEXT("Format="), Format);
+	FParse::Value(*Params, TEXT("Out="), Out);
+
+	bool bIsRegionFormat = Format.Equals(TEXT("Region"), ESearchCase::IgnoreCase);
+
+	if (Out.IsEmpty())
+	{
+		Out = bIsRegionFormat ?
+			FPaths::ProjectSavedDir() / TEXT("Worlds") / FString::Printf(TEXT("Baked_%d"), Seed) :
+			FPaths::ProjectSavedDir() / TEXT("Baked") / FString::Printf(TEXT("World_%d.vxw"), Seed);
+	}
+
+	if (MaxX < MinX || MaxY < MinY || Width <= 0 || Height <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("VoxelBake: invalid chunk rectangle or chunk size"));
+		return 1;
+	}
+
+	FIntPoint MinChunk = FIntPoint(MinX, MinY);
+	FIntPoint Size = FIntPoint(MaxX - MinX + 1, MaxY - MinY + 1);
+	int32 ChunkCount = Size.X * Size.Y;
+
+	//Same as AChunkManager::CreateGenerationSettings, so the world hash matches
+	BakeParams.BlockSize = BlockSize;
+	BakeParams.ChunkWidth = Width;
+	BakeParams.ChunkHeight = Height;
+
+	TUniquePtr<FVoxelBakedWorldWriter> BakedWriter;
+	TSharedPtr<FVoxelRegionStore> RegionStore;
+
+	if (bIsRegionFormat)
+	{
+		RegionStore = MakeShared<FVoxelRegionStore>(Out);
+	}
+	else
+	{
+		BakedWriter = MakeUnique<FVoxelBakedWorldWriter>(Out, Width, Height, MinChunk, Size, FVoxelGenerator::HashWorld(Seed, BakeParams));
+		if (!BakedWriter->IsValid())
+		{
+			UE_LOG(LogTemp, Error, TEXT("VoxelBake: could not open %s for writing"), *Out);
+			return 1;
+		}
+	}
+
+	FVoxelNoiseTileCache::Get().SetMaxBytes(static_cast<int64>(NoiseCacheMB) * 1024 * 1024);
+	FVoxelNoiseTileCache::Get().ResetStats();
+
+	UE_LOG(LogTemp, Display, TEXT("VoxelBake: generating %d chunks with seed %d (world hash %016llx) into %s"), ChunkCount, Seed, FVoxelGenerator::HashWorld(Seed, BakeParams), *Out);
+
+	double StartTime = FPlatformTime::Seconds();
+	std::atomic<int32> FailedChunks = 0;
+
+	FVoxelGenerationTimings Timings;
+	FCriticalSection TimingsLock;
+
+	ParallelFor(ChunkCount, [&](int32 ChunkIndex)
+	{
+		FIntPoint ChunkCoord = MinChunk + FIntPoint(ChunkIndex % Size.X, ChunkIndex / Size.X);
+
+		FVoxelChunkBuffer Buffer;
+		FVoxelGenerationTimings ChunkTimings;
+		FVoxelGenerator::Generate(ChunkCoord, Seed, BakeParams, Buffer, &ChunkTimings);
+
+		{
+			FScopeLock Lock(&TimingsLock);
+			for (int32 Stage = 0; Stage < static_cast<int32>(EVoxelGenerationStage::Count); Stage++)
+			{
+				Timings.StageCycles[Stage] += ChunkTimings.StageCycles[Stage];
+			}
+		}
+
+		if (RegionStore)
+		{
+			RegionStore->SaveChunk(ChunkCoord, Width, Height, Buffer.Blocks, &Buffer.BorderSolid);
+			return;
+		}
+
+		if (!BakedWriter->WriteChunk(ChunkCoord, Buffer.Blocks, Buffer.BorderSolid))
+			FailedChunks++;
+	});
+
+	double GenerateTime = FPlatformTime::Seconds() - StartTime;
+
+	bool bIsWritten = RegionStore ? true : BakedWriter->Close();
+	if (RegionStore)
+	{
+		RegionStore->Flush();
+	}
+
+	double TotalTime = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogTemp, Display, TEXT("VoxelBake: %d chunks in %.2fs (%.1f chunks/s generating, %.1f chunks/s total) on %d workers"),
+		ChunkCount,
+		TotalTime,
+		ChunkCount / FMath::Max(GenerateTime, UE_SMALL_NUMBER),
+		ChunkCount / FMath::Max(TotalTime, UE_SMALL_NUMBER),
+		FTaskGraphInterface::Get().GetNumWorkerThreads() + 1
+	);
+
+	FVoxelNoiseTileCacheStats CacheStats = FVoxelNoiseTileCache::Get().GetStats();
+	UE_LOG(LogTemp, Display, TEXT("VoxelBake: noise tile cache %.1f%% hits (%llu hits, %llu misses, %llu evictions), %.1f MB"),
+		CacheStats.GetHitRate() * 100.0,
+		CacheStats.Hits,
+		CacheStats.Misses,
+		CacheStats.Evictions,
+		CacheStats.Bytes / (1024.0 * 1024.0)
+	);
+
+	//Summed over all workers, so these add up to more than the wall time
+	for (int32 Stage = 0; Stage < static_cast<int32>(EVoxelGenerationStage::Count); Stage++)
+	{
+		if (Timings.StageCycles[Stage] == 0) continue;
+
+		double StageTime = FPlatformTime::ToMilliseconds64(Timings.StageCycles[Stage]);
+		UE_LOG(LogTemp, Display, TEXT("VoxelBake: stage %s %.1fms total, %.3fms per chunk"),
+			FVoxelGenerator::GetStageName(static_cast<EVoxelGenerationStage>(Stage)),
+			StageTime,
+			StageTime / ChunkCount
+		);
+	}
+
+	if (!bIsWritten || FailedChunks > 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("VoxelBake: failed to write %s (%d chunks failed)"), *Out, FailedChunks.load());
+		return 1;
+	}
+
+	return 0;
+}
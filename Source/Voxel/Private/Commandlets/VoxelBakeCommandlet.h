@@ -0,0 +1,37 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "../Structs/VoxelGeneratorParams.h"
+#include "VoxelBakeCommandlet.generated.h"
+
+/**
+ * Generates a rectangle of chunks without a world or actors and writes them to disk.
+ * 
+ * Chunks are generated in parallel on all worker threads.
+ * 
+ * Generator parameters come from the [/Script/Voxel.VoxelBakeCommandlet] section of the game config,
+   or from a placed chunk manager given by -ChunkManager, which also gives the seed and chunk size.
+   Values on the command line override both. The baked file is only used by worlds with the same result.
+ * 
+ * Usage:
+ * UnrealEditor-Cmd Voxel.uproject -run=VoxelBake -nullrhi -Seed=1337 -MinX=-16 -MinY=-16 -MaxX=15 -MaxY=15
+   [-ChunkManager=/Game/Maps/Main.Main:PersistentLevel.ChunkManager_0]
+   [-Format=Baked|Region] [-Out=Path] [-BlockSize=100] [-Width=32] [-Height=32]
+ */
+UCLASS(Config = Game)
+class UVoxelBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UVoxelBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+	/**
+	 * Generator parameters used when no chunk manager is given.
+	 */
+	UPROPERTY(Config)
+	FVoxelGeneratorParams GeneratorParams;
+};
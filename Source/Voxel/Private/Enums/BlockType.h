@@ -5,5 +5,7 @@ enum class EBlockType : uint8
 {
     Air = 0 UMETA(DisplayName="Air"),
     Grass = 1 UMETA(DisplayName="Grass"),
-    Stone = 2 UMETA(DisplayName="Stone")
+    Stone = 2 UMETA(DisplayName="Stone"),
+    Torch = 3 UMETA(DisplayName="Torch"),
+    Lava = 4 UMETA(DisplayName="Lava")
 };
\ No newline at end of file
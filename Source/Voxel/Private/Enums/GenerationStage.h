@@ -0,0 +1,13 @@
+#pragma once
+
+UENUM(BlueprintType)
+enum class EVoxelGenerationStage : uint8
+{
+    BaseDensity = 0 UMETA(DisplayName="Base Density"),
+    Biome = 1 UMETA(DisplayName="Biome"),
+    Surface = 2 UMETA(DisplayName="Surface"),
+    Caves = 3 UMETA(DisplayName="Caves"),
+    Decoration = 4 UMETA(DisplayName="Decoration"),
+    Overhangs = 5 UMETA(DisplayName="Overhangs"),
+    Count = 6 UMETA(Hidden)
+};
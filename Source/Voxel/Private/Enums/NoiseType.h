@@ -0,0 +1,41 @@
+#pragma once
+
+//Same order as FastNoiseLite::NoiseType
+UENUM(BlueprintType)
+enum class EVoxelNoiseType : uint8
+{
+    OpenSimplex2 = 0 UMETA(DisplayName="OpenSimplex2"),
+    OpenSimplex2S = 1 UMETA(DisplayName="OpenSimplex2S"),
+    Cellular = 2 UMETA(DisplayName="Cellular"),
+    Perlin = 3 UMETA(DisplayName="Perlin"),
+    ValueCubic = 4 UMETA(DisplayName="Value Cubic"),
+    Value = 5 UMETA(DisplayName="Value")
+};
+
+//Same order as FastNoiseLite::FractalType, without the domain warp types
+UENUM(BlueprintType)
+enum class EVoxelFractalType : uint8
+{
+    None = 0 UMETA(DisplayName="None"),
+    FBm = 1 UMETA(DisplayName="FBm"),
+    Ridged = 2 UMETA(DisplayName="Ridged"),
+    PingPong = 3 UMETA(DisplayName="Ping Pong")
+};
+
+//Same order as FastNoiseLite::DomainWarpType
+UENUM(BlueprintType)
+enum class EVoxelDomainWarpType : uint8
+{
+    OpenSimplex2 = 0 UMETA(DisplayName="OpenSimplex2"),
+    OpenSimplex2Reduced = 1 UMETA(DisplayName="OpenSimplex2 Reduced"),
+    BasicGrid = 2 UMETA(DisplayName="Basic Grid")
+};
+
+//Domain warp types of FastNoiseLite::FractalType
+UENUM(BlueprintType)
+enum class EVoxelDomainWarpFractalType : uint8
+{
+    None = 0 UMETA(DisplayName="None"),
+    Progressive = 1 UMETA(DisplayName="Progressive"),
+    Independent = 2 UMETA(DisplayName="Independent")
+};
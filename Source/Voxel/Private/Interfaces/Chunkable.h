@@ -6,7 +6,9 @@
 #include "Chunkable.generated.h"
 
 struct FBlock;
-class FastNoiseLite;
+struct FVoxelBitset;
+struct FVoxelGenerationSettings;
+struct FVoxelCollisionJob;
 class AChunkManager;
 enum class EBlockType : uint8;
 
@@ -34,7 +36,14 @@ public:
 	/**
 	 * Generates the chunk data based on noise. It does not create the mesh.
 	 */
-	virtual void GenerateChunk(const TSharedPtr<FastNoiseLite>& Noise) = 0;
+	virtual void GenerateChunk(const TSharedPtr<const FVoxelGenerationSettings>& Settings) = 0;
+
+	/**
+	 * Sets the chunk data from previously saved blocks instead of generating it.
+	 * Settings are still needed to mesh the borders towards chunks that are not loaded,
+	   InBorderSolid tells which blocks around the chunk are solid and may be empty.
+	 */
+	virtual void LoadChunk(const TSharedPtr<const FVoxelGenerationSettings>& Settings, TArray<FBlock>&& InBlocks, FVoxelBitset&& InBorderSolid) = 0;
 
 	/**
 	 * Creates data for the mesh for the chunk using the generated chunk data.
@@ -43,11 +52,44 @@ public:
 	 */
 	virtual void CreateChunkMesh(bool IsGenerating) = 0;
 
+	/**
+	 * Copies the light right around the chunk from its neighbours, for the next CreateChunkMesh.
+	 * Must run on the game thread before a mesh job starts, the job itself can not read other chunks.
+	 */
+	virtual void CaptureBorderLight() = 0;
+
 	/**
 	 * Appllies the mesh date and creates the mesh.
 	 */
 	virtual void ApplyMesh() = 0;
 
+	/**
+	 * Turns the collision of the chunk on or off. Turning it off drops the collision right away.
+	 */
+	virtual void SetCollisionEnabled(bool bEnabled) = 0;
+
+	/**
+	 * Returns true if the chunk builds collision.
+	 */
+	virtual bool IsCollisionEnabled() const = 0;
+
+	/**
+	 * Returns a job building the collision from a copy of the blocks, which can run on a background thread.
+	 * Returns nullptr if collision is off, up to date or a job for the chunk is still running.
+	 */
+	virtual TSharedPtr<FVoxelCollisionJob> StartCollisionBuild() = 0;
+
+	/**
+	 * Hands the collision built by a job to physics, which cooks it asynchronously.
+	 * Results of jobs started before the chunk was cleared or dropped its collision are ignored.
+	 */
+	virtual void FinishCollisionBuild(const FVoxelCollisionJob& Job) = 0;
+
+	/**
+	 * Returns true if a mesh was applied since the chunk was last cleared.
+	 */
+	virtual bool IsMeshed() const = 0;
+
 	/**
 	 * Clear chunk data.
 	 */
@@ -65,7 +107,27 @@ public:
 	virtual void AddPotentialBlock(const FVector& Position) = 0;
 
 	/**
-	 * Returns all blocks in this chunk.
+	 * Returns the block at a world position, or nullptr if it is not in this chunk.
+	 */
+	virtual FBlock* GetBlock(const FVector& Position) = 0;
+
+	/**
+	 * Returns all blocks in this chunk, empty if the chunk has no data yet.
+	 */
+	virtual const TArray<FBlock>& GetBlocks() const = 0;
+
+	/**
+	 * Returns all blocks in this chunk for changes that keep their types, like light updates.
+	 */
+	virtual TArray<FBlock>& GetMutableBlocks() = 0;
+
+	/**
+	 * Returns which blocks right around the chunk are solid, empty if not known.
+	 */
+	virtual const FVoxelBitset& GetBorderSolid() const = 0;
+
+	/**
+	 * Returns true if blocks were changed since the chunk was generated or loaded.
 	 */
-	virtual TMap<FVector, FBlock>& GetBlocks() = 0;
+	virtual bool IsModified() const = 0;
 };
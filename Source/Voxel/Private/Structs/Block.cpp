@@ -29,3 +29,17 @@ FBlock::FBlock(const EBlockType& InType, uint8 InLight, bool InIsDestroyable)
 FBlock::~FBlock()
 {
 }
+
+FArchive& operator<<(FArchive& Ar, FBlock& Block)
+{
+	uint8 IsDestroyable = Block.IsDestroyable ? 1 : 0;
+
+	Ar << Block.Type;
+	Ar << Block.DecorationId;
+	Ar << Block.Light;
+	Ar << IsDestroyable;
+
+	Block.IsDestroyable = IsDestroyable != 0;
+
+	return Ar;
+}
@@ -14,11 +14,22 @@ struct FBlock
 
 		EBlockType Type;
 		uint16 DecorationId;
+
+		//Sky light in the high nibble, light of emissive blocks in the low nibble
 		uint8 Light;
 		bool IsDestroyable;
 
+		static constexpr uint8 MaxLight = 15;
+
 		FBlock();
 		FBlock(const EBlockType& InType, uint8 InLight, bool InIsDestroyable);
 		FBlock(const EBlockType& InType, uint16 InDecorationId, uint8 InLight, bool InIsDestroyable);
 		~FBlock();
+
+		FORCEINLINE uint8 GetSkyLight() const { return Light >> 4; }
+		FORCEINLINE uint8 GetBlockLight() const { return Light & 0x0F; }
+		FORCEINLINE void SetSkyLight(uint8 Level) { Light = (Light & 0x0F) | (Level << 4); }
+		FORCEINLINE void SetBlockLight(uint8 Level) { Light = (Light & 0xF0) | Level; }
+
+		friend FArchive& operator<<(FArchive& Ar, FBlock& Block);
 };
@@ -0,0 +1,73 @@
+
+#include "Structs/VoxelBitset.h"
+
+FVoxelBitset::FVoxelBitset()
+{
+	NumBits = 0;
+}
+
+void FVoxelBitset::Init(int32 InNumBits)
+{
+	NumBits = InNumBits;
+	Words.Init(0, (InNumBits + 63) / 64);
+}
+
+void FVoxelBitset::ClearAll()
+{
+	FMemory::Memzero(Words.GetData(), Words.Num() * sizeof(uint64));
+}
+
+void FVoxelBitset::Reset()
+{
+	NumBits = 0;
+	Words.Empty();
+}
+
+void FVoxelBitset::Set(int32 Index)
+{
+	check(Index >= 0 && Index < NumBits);
+	Words[Index >> 6] |= uint64(1) << (Index & 63);
+}
+
+void FVoxelBitset::Clear(int32 Index)
+{
+	check(Index >= 0 && Index < NumBits);
+	Words[Index >> 6] &= ~(uint64(1) << (Index & 63));
+}
+
+bool FVoxelBitset::Contains(int32 Index) const
+{
+	if (Index < 0 || Index >= NumBits) return false;
+
+	return (Words[Index >> 6] & (uint64(1) << (Index & 63))) != 0;
+}
+
+bool FVoxelBitset::IsEmpty() const
+{
+	for (uint64 Word : Words)
+	{
+		if (Word != 0) return false;
+	}
+
+	return true;
+}
+
+int32 FVoxelBitset::Num() const
+{
+	return NumBits;
+}
+
+FArchive& operator<<(FArchive& Ar, FVoxelBitset& Bitset)
+{
+	Ar << Bitset.NumBits;
+
+	if (Ar.IsLoading())
+	{
+		Bitset.NumBits = FMath::Max(Bitset.NumBits, 0);
+		Bitset.Words.SetNumUninitialized((Bitset.NumBits + 63) / 64);
+	}
+
+	Ar.Serialize(Bitset.Words.GetData(), Bitset.Words.Num() * sizeof(uint64));
+
+	return Ar;
+}
@@ -0,0 +1,69 @@
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Fixed size set of bits, one bit per block of a chunk.
+ * 
+ * Set bits are visited by scanning whole words, so empty regions cost
+   one compare per 64 blocks.
+ */
+struct FVoxelBitset
+{
+	public:
+		FVoxelBitset();
+
+		/**
+		 * Resizes the set to hold NumBits bits, all cleared.
+		 */
+		void Init(int32 InNumBits);
+
+		/**
+		 * Clears all bits and releases nothing, so the set can be refilled without allocating.
+		 */
+		void ClearAll();
+
+		/**
+		 * Releases the memory of the set.
+		 */
+		void Reset();
+
+		void Set(int32 Index);
+		void Clear(int32 Index);
+		bool Contains(int32 Index) const;
+		bool IsEmpty() const;
+		int32 Num() const;
+
+		/**
+		 * Words holding the bits, 64 per word with bit 0 first, for storing the set as raw memory.
+		 */
+		uint64* GetWords() { return Words.GetData(); }
+		const uint64* GetWords() const { return Words.GetData(); }
+		int32 NumWords() const { return Words.Num(); }
+
+		friend FArchive& operator<<(FArchive& Ar, FVoxelBitset& Bitset);
+
+		/**
+		 * Calls Func with the index of every set bit, in ascending order.
+		 * Bits may be cleared by Func while iterating.
+		 */
+		template <typename FuncType>
+		void ForEachSetBit(FuncType&& Func) const
+		{
+			for (int32 WordIndex = 0; WordIndex < Words.Num(); WordIndex++)
+			{
+				uint64 Word = Words[WordIndex];
+				while (Word != 0)
+				{
+					int32 Bit = static_cast<int32>(FMath::CountTrailingZeros64(Word));
+					Word &= Word - 1;
+					Func(WordIndex * 64 + Bit);
+				}
+			}
+		}
+
+	private:
+		TArray<uint64> Words;
+		int32 NumBits;
+};
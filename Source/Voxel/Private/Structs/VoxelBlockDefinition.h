@@ -0,0 +1,52 @@
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "../Enums/BlockType.h"
+#include "VoxelBlockDefinition.generated.h"
+
+/**
+ * How one block type looks and behaves, as edited in UVoxelBlockDataAsset.
+ */
+USTRUCT(BlueprintType)
+struct FVoxelBlockDefinition
+{
+	public:
+		GENERATED_BODY()
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Block")
+		EBlockType Type = EBlockType::Stone;
+
+		/**
+		 * Hides the faces of blocks behind it and stops light.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Block")
+		bool bIsOpaque = true;
+
+		/**
+		 * Rendered with the see-through blocks instead of the opaque ones.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Block")
+		bool bIsTransparent = false;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Block")
+		bool bIsCollidable = true;
+
+		/**
+		 * Light level the block gives off, from 0 to 15.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Block", meta = (ClampMin = "0", ClampMax = "15"))
+		uint8 Emission = 0;
+
+		/**
+		 * Slices of the block texture array used by the top face, the four side faces and the bottom face.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Block", meta = (ClampMin = "0", ClampMax = "65535"))
+		int32 TopTexture = 0;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Block", meta = (ClampMin = "0", ClampMax = "65535"))
+		int32 SideTexture = 0;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Block", meta = (ClampMin = "0", ClampMax = "65535"))
+		int32 BottomTexture = 0;
+};
@@ -0,0 +1,50 @@
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Block.h"
+#include "VoxelBitset.h"
+
+/**
+ * Blocks of one chunk as produced by the generator, with the bounds of the solid blocks per column.
+ * 
+ * Blocks are stored column by column (Z changes fastest). Empty columns have Min > Max.
+ */
+struct FVoxelChunkBuffer
+{
+	public:
+		TArray<FBlock> Blocks;
+		TArray<int16> ColumnMinZ;
+		TArray<int16> ColumnMaxZ;
+
+		/**
+		 * Which blocks right outside the four sides of the chunk are solid, so border faces
+		   can be culled without the neighbour chunk. Empty when not known.
+		 */
+		FVoxelBitset BorderSolid;
+
+		/**
+		 * Bit of a block outside the chunk. Side is the face direction leaving the chunk
+		   (X, Y, nX or nY) and Along the coordinate of the block along that side.
+		 */
+		static int32 GetBorderIndex(int32 Side, int32 Along, int32 Z, int32 Width, int32 Height)
+		{
+			return (Side * Width + Along) * Height + Z;
+		}
+
+		/**
+		 * Local column of a block outside the chunk, as used by GetBorderIndex.
+		 */
+		static FIntPoint GetBorderColumn(int32 Side, int32 Along, int32 Width)
+		{
+			switch (Side)
+			{
+				case 0: return FIntPoint(Width, Along);
+				case 1: return FIntPoint(Along, Width);
+				case 2: return FIntPoint(-1, Along);
+				default: return FIntPoint(Along, -1);
+			}
+		}
+
+		static constexpr int32 NumBorderSides = 4;
+};
@@ -0,0 +1,204 @@
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "../Enums/NoiseType.h"
+#include "../Enums/BlockType.h"
+#include "../Enums/GenerationStage.h"
+#include "VoxelGeneratorParams.generated.h"
+
+/**
+ * Settings of one FastNoiseLite noise.
+ */
+USTRUCT(BlueprintType)
+struct FVoxelNoiseParams
+{
+	public:
+		GENERATED_BODY()
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Noise")
+		EVoxelNoiseType NoiseType = EVoxelNoiseType::Perlin;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Noise")
+		float Frequency = 0.02f;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Noise")
+		EVoxelFractalType FractalType = EVoxelFractalType::FBm;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Noise")
+		int32 Octaves = 3;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Noise")
+		float Lacunarity = 2.0f;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Noise")
+		float Gain = 0.3f;
+};
+
+/**
+ * Look of the terrain in one biome.
+ */
+USTRUCT(BlueprintType)
+struct FVoxelBiomeParams
+{
+	public:
+		GENERATED_BODY()
+
+		/**
+		 * Columns use the first biome whose MaxBiomeNoise is at or above their biome noise value.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Biome")
+		float MaxBiomeNoise = 1.0f;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Biome")
+		EBlockType SurfaceType = EBlockType::Grass;
+
+		/**
+		 * Share of surface blocks that get a decoration, from 0 to 1.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Biome")
+		float DecorationDensity = 0.0f;
+};
+
+/**
+ * Everything besides the seed and the chunk coordinate that decides which blocks a chunk gets.
+ */
+USTRUCT(BlueprintType)
+struct FVoxelGeneratorParams
+{
+	public:
+		GENERATED_BODY()
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator")
+		int32 BlockSize = 100;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator")
+		int32 ChunkWidth = 32;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator")
+		int32 ChunkHeight = 32;
+
+		/**
+		 * World units per noise unit, the noise is sampled at world position / NoiseScale.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator")
+		float NoiseScale = 100.0f;
+
+		/**
+		 * Terrain height in blocks the height noise is mapped to.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator")
+		int32 MinTerrainHeight = 6;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator")
+		int32 MaxTerrainHeight = 32;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator")
+		FVoxelNoiseParams HeightNoise;
+
+		/**
+		 * Warps the coordinates the height noise is sampled at, for less regular terrain.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Domain Warp")
+		bool bDomainWarp = false;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Domain Warp")
+		EVoxelDomainWarpType DomainWarpType = EVoxelDomainWarpType::OpenSimplex2;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Domain Warp")
+		EVoxelDomainWarpFractalType DomainWarpFractalType = EVoxelDomainWarpFractalType::Progressive;
+
+		/**
+		 * Largest distance a sample is moved, in height noise coordinates.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Domain Warp")
+		float DomainWarpAmplitude = 20.0f;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Domain Warp")
+		float DomainWarpFrequency = 0.01f;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Domain Warp")
+		int32 DomainWarpOctaves = 3;
+
+		/**
+		 * The warp is only evaluated every this many blocks and interpolated in between.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Domain Warp", meta = (ClampMin = 1))
+		int32 WarpCellSize = 8;
+
+		/**
+		 * Stages a chunk goes through, in order. Base Density always runs first, whether listed or not.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Stages")
+		TArray<EVoxelGenerationStage> Stages = {
+			EVoxelGenerationStage::BaseDensity,
+			EVoxelGenerationStage::Biome,
+			EVoxelGenerationStage::Overhangs,
+			EVoxelGenerationStage::Caves,
+			EVoxelGenerationStage::Surface,
+			EVoxelGenerationStage::Decoration
+		};
+
+		/**
+		 * Block type the base density stage fills the ground with.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Stages")
+		EBlockType FillType = EBlockType::Stone;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Stages")
+		FVoxelNoiseParams BiomeNoise = { EVoxelNoiseType::OpenSimplex2, 0.004f, EVoxelFractalType::None, 1, 2.0f, 0.5f };
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Stages")
+		TArray<FVoxelBiomeParams> Biomes = {
+			{ 0.3f, EBlockType::Grass, 0.05f },
+			{ 1.0f, EBlockType::Stone, 0.0f }
+		};
+
+		/**
+		 * How many blocks from the top of a column are painted with the biome surface type.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Stages")
+		int32 SurfaceDepth = 3;
+
+		/**
+		 * 3D noise is only sampled every this many blocks and interpolated in between.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Stages", meta = (ClampMin = 1))
+		int32 DensityCellSize = 4;
+
+		/**
+		 * Cells whose corner samples already decide every block in them are filled without interpolating.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Stages")
+		bool bSkipUniformCells = true;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Stages")
+		FVoxelNoiseParams OverhangNoise = { EVoxelNoiseType::OpenSimplex2, 0.03f, EVoxelFractalType::None, 1, 2.0f, 0.5f };
+
+		/**
+		 * How many blocks the overhang noise can move the surface up or down.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Stages")
+		float OverhangStrength = 4.0f;
+
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Stages")
+		FVoxelNoiseParams CaveNoise = { EVoxelNoiseType::OpenSimplex2, 0.05f, EVoxelFractalType::None, 1, 2.0f, 0.5f };
+
+		/**
+		 * Blocks where the cave noise is above this value are carved out.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Stages")
+		float CaveThreshold = 0.6f;
+
+		/**
+		 * Caves stay at least this many blocks below the surface.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Stages")
+		int32 CaveSurfaceMargin = 4;
+
+		/**
+		 * Number of different decoration ids placed by the decoration stage.
+		 */
+		UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Generator|Stages")
+		int32 DecorationVariants = 4;
+};
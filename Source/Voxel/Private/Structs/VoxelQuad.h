@@ -0,0 +1,55 @@
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * One block face of a chunk mesh packed into 8 bytes.
+ * 
+ * Only the block position inside the chunk and the face direction are stored,
+   the corners, normal and UVs are rebuilt from the face tables when the mesh is uploaded.
+ * 
+ * PositionAndFace: X (10 bits) | Y (10 bits) | Z (9 bits) | Face (3 bits)
+ * Attributes: TextureIndex (16 bits) | Light (8 bits) | Occlusion (8 bits)
+ * TextureIndex is the slice of the block texture array the face samples.
+ * Light is the packed FBlock::Light of the block the face looks into.
+ * Occlusion holds 2 bits per corner, in the order of the face tables, from 0 for a fully
+   occluded corner to 3 for an open one.
+ */
+struct FVoxelQuad
+{
+	public:
+		uint32 PositionAndFace;
+		uint32 Attributes;
+
+		//Largest chunk dimensions the position bits can hold, see AChunkManager::ChunkWidth and ChunkHeight
+		static constexpr int32 MaxWidth = 1 << 10;
+		static constexpr int32 MaxHeight = 1 << 9;
+
+		static FORCEINLINE FVoxelQuad Pack(int32 X, int32 Y, int32 Z, int32 Face, uint16 TextureIndex, uint8 Light, uint8 Occlusion)
+		{
+			FVoxelQuad Quad;
+			Quad.PositionAndFace = uint32(X) | (uint32(Y) << 10) | (uint32(Z) << 20) | (uint32(Face) << 29);
+			Quad.Attributes = uint32(TextureIndex) | (uint32(Light) << 16) | (uint32(Occlusion) << 24);
+			return Quad;
+		}
+
+		FORCEINLINE int32 GetX() const { return PositionAndFace & 0x3FF; }
+		FORCEINLINE int32 GetY() const { return (PositionAndFace >> 10) & 0x3FF; }
+		FORCEINLINE int32 GetZ() const { return (PositionAndFace >> 20) & 0x1FF; }
+		FORCEINLINE int32 GetFace() const { return PositionAndFace >> 29; }
+		FORCEINLINE uint16 GetTextureIndex() const { return Attributes & 0xFFFF; }
+		FORCEINLINE uint8 GetLight() const { return (Attributes >> 16) & 0xFF; }
+		FORCEINLINE uint8 GetCornerOcclusion(int32 Corner) const { return (Attributes >> (24 + Corner * 2)) & 0x3; }
+
+		/**
+		 * Whether the face should be split along the diagonal from corner 0 to 3 instead of 1 to 2,
+		   so the darker corners do not bleed across the brighter diagonal.
+		 */
+		FORCEINLINE bool IsFlipped() const
+		{
+			return GetCornerOcclusion(0) + GetCornerOcclusion(3) > GetCornerOcclusion(1) + GetCornerOcclusion(2);
+		}
+};
+
+static_assert(sizeof(FVoxelQuad) == 8, "FVoxelQuad is expected to stay 8 bytes");
@@ -0,0 +1,38 @@
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "../Enums/BlockType.h"
+#include "VoxelRaycastHit.generated.h"
+
+/**
+ * Block hit by a ray walked through the voxel grid, see AChunkManager::VoxelRaycast.
+ */
+USTRUCT(BlueprintType)
+struct FVoxelRaycastHit
+{
+	public:
+		GENERATED_BODY()
+
+		/**
+		 * World location of the center of the hit block, as taken by AddBlock and RemoveBlock.
+		 */
+		UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		FVector BlockLocation = FVector::ZeroVector;
+
+		/**
+		 * Normal of the face the ray entered through. Adding it times the block size gives
+		   the block in front of the face. Zero when the ray started inside the block.
+		 */
+		UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		FVector Normal = FVector::ZeroVector;
+
+		/**
+		 * Distance from the start of the ray to where it entered the block.
+		 */
+		UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		float Distance = 0.0f;
+
+		UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		EBlockType BlockType = EBlockType::Air;
+};
@@ -3,4 +3,9 @@
 #include "Voxel.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_STAT(STAT_VoxelChunkMeshing);
+DEFINE_STAT(STAT_VoxelChunkFaceData);
+DEFINE_STAT(STAT_VoxelChunkCollision);
+DEFINE_STAT(STAT_VoxelMeshedFaces);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Voxel, "Voxel" );
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "../../Structs/VoxelBlockDefinition.h"
+#include "VoxelBlockDataAsset.generated.h"
+
+/**
+ * Block types of a world, turned into flat lookup tables by FVoxelBlockRegistry.
+ * Types missing from the list keep their built-in definition.
+ */
+UCLASS(BlueprintType)
+class UVoxelBlockDataAsset : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Blocks")
+	TArray<FVoxelBlockDefinition> Blocks;
+};
@@ -0,0 +1,68 @@
+#include "VoxelTerrain/Blocks/VoxelBlockRegistry.h"
+#include "VoxelBlockDataAsset.h"
+#include "../../Enums/Direction.h"
+#include "../../Structs/Block.h"
+#include "../../Structs/VoxelBlockDefinition.h"
+
+namespace
+{
+	FVoxelBlockDefinition MakeDefinition(EBlockType Type, int32 Texture, uint8 Emission)
+	{
+		FVoxelBlockDefinition Definition;
+		Definition.Type = Type;
+		Definition.Emission = Emission;
+		Definition.TopTexture = Texture;
+		Definition.SideTexture = Texture;
+		Definition.BottomTexture = Texture;
+		return Definition;
+	}
+}
+
+FVoxelBlockRegistry::FVoxelBlockRegistry()
+{
+	//Unknown types and air have no flags, so they are treated as empty space
+	FMemory::Memzero(Flags);
+	FMemory::Memzero(Emissions);
+	FMemory::Memzero(FaceTextures);
+
+	SetBlock(MakeDefinition(EBlockType::Grass, 0, 0));
+	SetBlock(MakeDefinition(EBlockType::Stone, 1, 0));
+	//TA_Blocks only holds grass and stone so far, torch and lava borrow the stone slice until their textures are added
+	SetBlock(MakeDefinition(EBlockType::Torch, 1, 14));
+	SetBlock(MakeDefinition(EBlockType::Lava, 1, FBlock::MaxLight));
+}
+
+FVoxelBlockRegistry::FVoxelBlockRegistry(const UVoxelBlockDataAsset& Asset)
+	: FVoxelBlockRegistry()
+{
+	for (const FVoxelBlockDefinition& Definition : Asset.Blocks)
+	{
+		SetBlock(Definition);
+	}
+}
+
+void FVoxelBlockRegistry::SetBlock(const FVoxelBlockDefinition& Definition)
+{
+	if (Definition.Type == EBlockType::Air)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Block definition for Air is ignored, air is always empty"));
+		return;
+	}
+
+	uint8 Index = static_cast<uint8>(Definition.Type);
+
+	Flags[Index] = FlagSolid;
+	if (Definition.bIsOpaque) Flags[Index] |= FlagOpaque;
+	if (Definition.bIsTransparent) Flags[Index] |= FlagTransparent;
+	if (Definition.bIsCollidable) Flags[Index] |= FlagCollidable;
+
+	Emissions[Index] = FMath::Min<uint8>(Definition.Emission, FBlock::MaxLight);
+
+	for (int32 Face = 0; Face < 6; Face++)
+	{
+		FaceTextures[Index][Face] = static_cast<uint16>(FMath::Clamp<int32>(Definition.SideTexture, 0, MAX_uint16));
+	}
+
+	FaceTextures[Index][static_cast<int32>(EFaceDirection::Z)] = static_cast<uint16>(FMath::Clamp<int32>(Definition.TopTexture, 0, MAX_uint16));
+	FaceTextures[Index][static_cast<int32>(EFaceDirection::nZ)] = static_cast<uint16>(FMath::Clamp<int32>(Definition.BottomTexture, 0, MAX_uint16));
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "../../Enums/BlockType.h"
+
+struct FVoxelBlockDefinition;
+class UVoxelBlockDataAsset;
+
+/**
+ * Properties of every block type in flat tables indexed by the type.
+ * 
+ * Meshing, lighting and collision look properties up here instead of comparing types,
+   so a lookup costs one load whatever the number of types.
+ * Never changed after creation, so it is shared with background jobs through FVoxelGenerationSettings.
+ */
+class FVoxelBlockRegistry
+{
+public:
+	static constexpr int32 MaxTypes = 256;
+
+	/**
+	 * Registry with the built-in block types.
+	 */
+	FVoxelBlockRegistry();
+
+	/**
+	 * Registry with the built-in block types, overridden by the types defined in Asset.
+	 */
+	explicit FVoxelBlockRegistry(const UVoxelBlockDataAsset& Asset);
+
+	/**
+	 * Takes up its cell, anything but air.
+	 */
+	FORCEINLINE bool IsSolid(EBlockType Type) const { return (Flags[static_cast<uint8>(Type)] & FlagSolid) != 0; }
+
+	/**
+	 * Hides faces behind it and stops light.
+	 */
+	FORCEINLINE bool IsOpaque(EBlockType Type) const { return (Flags[static_cast<uint8>(Type)] & FlagOpaque) != 0; }
+
+	FORCEINLINE bool IsTransparent(EBlockType Type) const { return (Flags[static_cast<uint8>(Type)] & FlagTransparent) != 0; }
+
+	/**
+	 * Whether the face of a block of Type towards a block of NeighborType is seen.
+	 * Faces between blocks of one transparent type are inside the same volume, like water, and are culled.
+	 */
+	FORCEINLINE bool IsFaceVisible(EBlockType Type, EBlockType NeighborType) const
+	{
+		return !IsOpaque(NeighborType) && !(Type == NeighborType && IsTransparent(Type));
+	}
+
+	FORCEINLINE bool IsCollidable(EBlockType Type) const { return (Flags[static_cast<uint8>(Type)] & FlagCollidable) != 0; }
+
+	FORCEINLINE uint8 GetEmission(EBlockType Type) const { return Emissions[static_cast<uint8>(Type)]; }
+
+	/**
+	 * Texture array slice of one face of a block type, Face being an EFaceDirection.
+	 */
+	FORCEINLINE uint16 GetFaceTexture(EBlockType Type, int32 Face) const { return FaceTextures[static_cast<uint8>(Type)][Face]; }
+
+private:
+	enum : uint8
+	{
+		FlagSolid = 1 << 0,
+		FlagOpaque = 1 << 1,
+		FlagTransparent = 1 << 2,
+		FlagCollidable = 1 << 3
+	};
+
+	void SetBlock(const FVoxelBlockDefinition& Definition);
+
+	uint8 Flags[MaxTypes];
+	uint8 Emissions[MaxTypes];
+	uint16 FaceTextures[MaxTypes][6];
+};
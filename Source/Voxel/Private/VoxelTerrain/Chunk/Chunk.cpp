@@ -1,8 +1,14 @@
 #include "VoxelTerrain/Chunk/Chunk.h"
+#include "Voxel.h"
+#include "FaceTables.h"
 #include "../../Enums/BlockType.h"
 #include "../../Enums/Direction.h"
 #include "../../Structs/Block.h"
-#include "../../FastNoiseLite.h"
+#include "../../Structs/VoxelChunkBuffer.h"
+#include "../Generation/VoxelGenerator.h"
+#include "../Lighting/VoxelLightEngine.h"
+#include "../Blocks/VoxelBlockRegistry.h"
+#include "VoxelCollisionJob.h"
 #include "../World/ChunkManager.h"
 #include "ProceduralMeshComponent.h"
 #include "Components/SceneComponent.h"
@@ -10,6 +16,139 @@
 #include "Engine/World.h"
 #include "DrawDebugHelpers.h"
 
+namespace
+{
+	/**
+	 * Scratch memory of a meshing job. Every thread keeps its own, so the memory
+	   is reused by all jobs that run on it instead of being allocated per job.
+	 */
+	struct FMeshingScratch
+	{
+		//Blocks with an exposed face, one list per mesh section and direction
+		TArray<int32> FaceBlocks[AChunk::NumMeshSections][VoxelFace::NumDirections];
+	};
+
+	FMeshingScratch& GetMeshingScratch()
+	{
+		static thread_local FMeshingScratch Scratch;
+		return Scratch;
+	}
+
+	/**
+	 * Vertex streams the packed quads are expanded into right before upload.
+	 */
+	struct FMeshUploadScratch
+	{
+		TArray<FVector> Vertices;
+		TArray<FVector> Normals;
+		TArray<FVector2D> UVs;
+		TArray<FVector2D> TextureSlices;
+		TArray<int32> Triangles;
+		TArray<FColor> VertexColors;
+	};
+
+	FMeshUploadScratch& GetUploadScratch()
+	{
+		static thread_local FMeshUploadScratch Scratch;
+		return Scratch;
+	}
+
+	/**
+	 * Offsets from the block in front of a face to the two blocks sharing an edge with one
+	   of its corners. Added together they give the block sharing only the corner.
+	 */
+	void GetCornerSides(int32 Face, int32 Corner, FIntVector OutSides[2])
+	{
+		OutSides[0] = FIntVector::ZeroValue;
+		OutSides[1] = FIntVector::ZeroValue;
+		int32 SideIndex = 0;
+
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			if (VoxelFace::Offsets[Face][Axis] != 0) continue;
+
+			OutSides[SideIndex++][Axis] = VoxelFace::Corners[Face][Corner][Axis];
+		}
+	}
+
+	/**
+	 * Expands FaceCount quads starting at FirstFace.
+	 * CornerLights holds the smoothed light of every quad, 8 bits per corner, or is empty
+	   when every corner takes the light of its face.
+	 */
+	void ExpandQuads(
+		const TArray<FVoxelQuad>& Quads,
+		const TArray<uint32>& CornerLights,
+		int32 FirstFace,
+		int32 FaceCount,
+		const FVector& Origin,
+		int32 BlockSize,
+		FMeshUploadScratch& Out
+	)
+	{
+		bool bHasCornerLights = CornerLights.Num() == Quads.Num();
+		float HalfBlockSize = BlockSize / 2;
+
+		Out.Vertices.SetNumUninitialized(FaceCount * 4);
+		Out.Normals.SetNumUninitialized(FaceCount * 4);
+		Out.UVs.SetNumUninitialized(FaceCount * 4);
+		Out.TextureSlices.SetNumUninitialized(FaceCount * 4);
+		Out.VertexColors.SetNumUninitialized(FaceCount * 4);
+		Out.Triangles.SetNumUninitialized(FaceCount * 6);
+
+		FVector* Vertices = Out.Vertices.GetData();
+		FVector* Normals = Out.Normals.GetData();
+		FVector2D* UVs = Out.UVs.GetData();
+		FVector2D* TextureSlices = Out.TextureSlices.GetData();
+		FColor* VertexColors = Out.VertexColors.GetData();
+		int32* Triangles = Out.Triangles.GetData();
+
+		for (int32 FaceIndex = 0; FaceIndex < FaceCount; FaceIndex++)
+		{
+			const FVoxelQuad& Quad = Quads[FirstFace + FaceIndex];
+			int32 Face = Quad.GetFace();
+			FVector Position = Origin + FVector(Quad.GetX(), Quad.GetY(), Quad.GetZ() + 1) * BlockSize;
+			FVector Normal = FVector(VoxelFace::Offsets[Face][0], VoxelFace::Offsets[Face][1], VoxelFace::Offsets[Face][2]);
+			//Red picks the texture, green and blue carry sky and block light scaled to 0-255, alpha the occlusion
+			//The shipped block material still reads the slice from red, which only holds the first 256 slices
+			uint8 SkyLight = Quad.GetLight() >> 4;
+			uint8 BlockLight = Quad.GetLight() & 0x0F;
+			FColor VertexColor = FColor(Quad.GetTextureIndex() & 0xFF, SkyLight * 17, BlockLight * 17, 0);
+
+			//The second UV channel holds the full texture array slice, exact as a float, for materials that read it from there
+			FVector2D TextureSlice = FVector2D(Quad.GetTextureIndex(), 0);
+			int32 FirstVertex = FaceIndex * 4;
+			const int32* Corners = Quad.IsFlipped() ? VoxelFace::FlippedTriangleCorners : VoxelFace::TriangleCorners;
+
+			for (int32 i = 0; i < 4; i++)
+			{
+				Vertices[FirstVertex + i] = Position + FVector(
+					VoxelFace::Corners[Face][i][0],
+					VoxelFace::Corners[Face][i][1],
+					VoxelFace::Corners[Face][i][2]
+				) * HalfBlockSize;
+				Normals[FirstVertex + i] = Normal;
+				UVs[FirstVertex + i] = FVector2D(VoxelFace::CornerUVs[i][0], VoxelFace::CornerUVs[i][1]);
+				TextureSlices[FirstVertex + i] = TextureSlice;
+				VertexColors[FirstVertex + i] = VertexColor;
+				VertexColors[FirstVertex + i].A = Quad.GetCornerOcclusion(i) * 85;
+
+				if (bHasCornerLights)
+				{
+					uint8 CornerLight = CornerLights[FirstFace + FaceIndex] >> (i * 8);
+					VertexColors[FirstVertex + i].G = (CornerLight >> 4) * 17;
+					VertexColors[FirstVertex + i].B = (CornerLight & 0x0F) * 17;
+				}
+			}
+
+			for (int32 i = 0; i < 6; i++)
+			{
+				Triangles[FaceIndex * 6 + i] = FirstVertex + Corners[i];
+			}
+		}
+	}
+}
+
 AChunk::AChunk()
 {
 	PrimaryActorTick.bCanEverTick = false;
@@ -17,15 +156,17 @@ AChunk::AChunk()
 	BlockSize = 100;
 	Width = 32;
 	Height = 32;
-
-	Directions = {
-		EFaceDirection::X,
-		EFaceDirection::Y,
-		EFaceDirection::nX,
-		EFaceDirection::nY,
-		EFaceDirection::nZ,
-		EFaceDirection::Z,
-	};
+	MinSolidZ = 0;
+	MaxSolidZ = -1;
+	bIsModified = false;
+	bSmoothLighting = true;
+	bCollisionEnabled = false;
+	bCollisionDirty = true;
+	bCollisionInFlight = false;
+	CollisionGeneration = 0;
+	bIsMeshed = false;
+	Registry = nullptr;
+	FirstTransparentQuad = 0;
 
 	Mesh = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("Mesh"));
 	Mesh->SetCastShadow(true);
@@ -33,6 +174,13 @@ AChunk::AChunk()
 	Mesh->bCastContactShadow = true;
 	Mesh->bCastStaticShadow = true;
 	Mesh->bAffectDynamicIndirectLighting = true;
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	CollisionMesh = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("CollisionMesh"));
+	CollisionMesh->SetCastShadow(false);
+	CollisionMesh->SetHiddenInGame(true);
+	//Collision is cooked off the game thread, the old collision stays until the new one is ready
+	CollisionMesh->bUseAsyncCooking = true;
 
 	RootSceneComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootSceneComponent"));
 
@@ -42,75 +190,151 @@ AChunk::AChunk()
 
 void AChunk::InitBaseData(const TObjectPtr<AChunkManager>& InManager, int32 InBlockSize, int32 InWidth, int32 InHeight)
 {
+	//Faces store local positions in a few bits each, larger chunks would wrap around
+	check(InWidth > 0 && InWidth <= FVoxelQuad::MaxWidth);
+	check(InHeight > 0 && InHeight <= FVoxelQuad::MaxHeight);
+
 	Manager = InManager;
+	bSmoothLighting = InManager->bSmoothLighting;
 	BlockSize = InBlockSize;
 	Width = InWidth;
 	Height = InHeight;
+
+	if (TransparentMaterial)
+		Mesh->SetMaterial(TransparentSection, TransparentMaterial);
 }
 
-void AChunk::GenerateChunk(const TSharedPtr<FastNoiseLite>& InNoise)
+void AChunk::GenerateChunk(const TSharedPtr<const FVoxelGenerationSettings>& InSettings)
 {
-	Noise = InNoise;
-	FVector RootLocation = RootComponent->GetRelativeLocation();
-	FVector NextBlockLocation;
-	int CurrentHeight = 0;
+	Settings = InSettings;
+	Registry = &Settings->Blocks.Get();
+	UpdateOrigin();
+	bIsModified = false;
+
+	//Hand the current storage to the generator so a pooled chunk does not reallocate
+	FVoxelChunkBuffer Buffer;
+	Buffer.Blocks = MoveTemp(Blocks);
+	Buffer.ColumnMinZ = MoveTemp(ColumnMinZ);
+	Buffer.ColumnMaxZ = MoveTemp(ColumnMaxZ);
+	Buffer.BorderSolid = MoveTemp(BorderSolid);
+
+	FVoxelGenerator::Generate(ChunkCoord, Settings->Seed, Settings->Params, Buffer);
+
+	Blocks = MoveTemp(Buffer.Blocks);
+	ColumnMinZ = MoveTemp(Buffer.ColumnMinZ);
+	ColumnMaxZ = MoveTemp(Buffer.ColumnMaxZ);
+	BorderSolid = MoveTemp(Buffer.BorderSolid);
+
+	UpdateChunkBounds();
+	FVoxelLightEngine::PropagateSkyLight(Blocks, *Registry, ColumnMaxZ, Width, Height);
+	FVoxelLightEngine::PropagateBlockLight(Blocks, *Registry, ColumnMinZ, ColumnMaxZ, Width, Height);
+	FindSurfaceBlocks();
+}
 
-	for (int Z = Height * BlockSize; Z > 0; Z -= BlockSize)
-	{
-		CurrentHeight = Z / BlockSize;
+void AChunk::LoadChunk(const TSharedPtr<const FVoxelGenerationSettings>& InSettings, TArray<FBlock>&& InBlocks, FVoxelBitset&& InBorderSolid)
+{
+	Settings = InSettings;
+	Registry = &Settings->Blocks.Get();
+	UpdateOrigin();
+	bIsModified = false;
 
-		for (int Y = 0; Y < Width * BlockSize; Y += BlockSize)
-		{
-			for (int X = 0; X < Width * BlockSize; X += BlockSize)
-			{
-				NextBlockLocation = RootLocation + FVector(X, Y, Z);
-				float BlockHeight = Noise->GetNoise(NextBlockLocation.X / 100, NextBlockLocation.Y / 100);
-				BlockHeight = LimitNoise(BlockHeight, 6, 32);
+	Blocks = MoveTemp(InBlocks);
+	BorderSolid = MoveTemp(InBorderSolid);
 
-				EBlockType RandomBlockType = (FMath::RandRange(0, 1) == 0) ? 
-					EBlockType::Stone : 
-					EBlockType::Grass;
+	if (BorderSolid.Num() != FVoxelChunkBuffer::NumBorderSides * Width * Height)
+		BorderSolid.Reset();
 
-				(CurrentHeight >= BlockHeight) ?
-					Blocks.Add(NextBlockLocation, FBlock(EBlockType::Air, 0, true)):
-					Blocks.Add(NextBlockLocation, FBlock(RandomBlockType, 0, true));
-			}
+	ColumnMinZ.SetNumUninitialized(Width * Width);
+	ColumnMaxZ.SetNumUninitialized(Width * Width);
+
+	for (int32 Y = 0; Y < Width; Y++)
+	{
+		for (int32 X = 0; X < Width; X++)
+		{
+			UpdateColumnBounds(X, Y);
 		}
 	}
 
-	//BuildLight();
+	UpdateChunkBounds();
+	FVoxelLightEngine::PropagateSkyLight(Blocks, *Registry, ColumnMaxZ, Width, Height);
+	FVoxelLightEngine::PropagateBlockLight(Blocks, *Registry, ColumnMinZ, ColumnMaxZ, Width, Height);
+	FindSurfaceBlocks();
+}
 
-	TArray<FVector> BlockLocs;
-	Blocks.GenerateKeyArray(BlockLocs);
-	TArray<FBlock> BlockTypes;
-	Blocks.GenerateValueArray(BlockTypes);
+void AChunk::FindSurfaceBlocks()
+{
+	SurfaceBlocks.Init(Width * Width * Height);
 
-	for (int i = 0; i < BlockLocs.Num(); i++)
+	for (int32 Y = 0; Y < Width; Y++)
 	{
-		if (BlockTypes[i].Type == EBlockType::Air) continue;
-
-		for (int j = 0; j < Directions.Num(); j++)
+		for (int32 X = 0; X < Width; X++)
 		{
-			if (!IsBlockNextToAirFast(Directions[j], BlockLocs[i])) continue;
+			for (int32 Z = ColumnMinZ[X + Width * Y]; Z <= ColumnMaxZ[X + Width * Y]; Z++)
+			{
+				const FBlock& Block = Blocks[GetBlockIndex(X, Y, Z)];
+				if (!Registry->IsSolid(Block.Type)) continue;
+
+				bool IsNextToAir = false;
+				VoxelFace::ForEachDirection([this, X, Y, Z, &IsNextToAir](auto DirectionTag)
+				{
+					constexpr EFaceDirection Direction = decltype(DirectionTag)::Value;
+					IsNextToAir |= IsBlockNextToAirFast<Direction>(FIntVector(X, Y, Z));
+				});
 
-			PotentialBlocks.Add(BlockLocs[i], BlockTypes[i].Type);
+				if (IsNextToAir)
+					SurfaceBlocks.Set(GetBlockIndex(X, Y, Z));
+			}
 		}
 	}
 }
 
 void AChunk::ModifyBlock(const FVector& Position, const EBlockType& NewType)
 {
-	auto Block = Blocks.Find(Position.GridSnap(BlockSize));
-	if (!Block) return;
+	FIntVector Local;
+	if (!WorldToLocal(Position, Local)) return;
+
+	Blocks[GetBlockIndex(Local.X, Local.Y, Local.Z)].Type = NewType;
+	bIsModified = true;
+	bCollisionDirty = true;
+	UpdateColumnBounds(Local.X, Local.Y);
+	UpdateChunkBounds();
+
+	//Neighbours touched by the light update or the new potential blocks, each is rebuilt once at the end
+	TSet<IChunkable*> DirtyNeighbors;
 
-	Block->Type = NewType;
-	PotentialBlocks.Add(Position, NewType);
+	Manager.Get()->UpdateLightAround(GetActorLocation(), Local, DirtyNeighbors);
 
-	AddPotentialBlocksAround(Position);
+	SurfaceBlocks.Set(GetBlockIndex(Local.X, Local.Y, Local.Z));
+
+	AddPotentialBlocksAround(Local, DirtyNeighbors);
 
 	EmptyMeshData();
+	CaptureBorderLight();
 	CreateChunkMesh(false);
 	ApplyMesh();
+
+	for (IChunkable* Neighbor : DirtyNeighbors)
+	{
+		if (Neighbor == this) continue;
+
+		Neighbor->CaptureBorderLight();
+		Neighbor->CreateChunkMesh(false);
+		Neighbor->ApplyMesh();
+	}
+}
+
+void AChunk::CaptureBorderLight()
+{
+	if (!Manager) return;
+
+	//Taken from the actor, the staging chunks of a regeneration capture before their blocks are generated
+	FVector Location = GetActorLocation();
+	FIntPoint Coord = FIntPoint(
+		FMath::RoundToInt32(Location.X / (BlockSize * Width)),
+		FMath::RoundToInt32(Location.Y / (BlockSize * Width))
+	);
+
+	Manager->GetBorderLight(Coord, BorderLight);
 }
 
 void AChunk::CreateChunkMesh(bool IsGenerating)
@@ -120,185 +344,380 @@ void AChunk::CreateChunkMesh(bool IsGenerating)
 
 void AChunk::ApplyMesh()
 {
-	Mesh->CreateMeshSection(
-		0,
-		Vertices,
-		Triangles,
-		Normals,
-		UVs,
-		VertexColors,
+	FMeshUploadScratch& Upload = GetUploadScratch();
+
+	for (int32 Section = 0; Section < NumMeshSections; Section++)
+	{
+		int32 FirstFace = Section == OpaqueSection ? 0 : FirstTransparentQuad;
+		int32 FaceCount = Section == OpaqueSection ? FirstTransparentQuad : Quads.Num() - FirstTransparentQuad;
+
+		//Most chunks have nothing see-through, so their transparent section stays empty
+		if (Section == TransparentSection && FaceCount == 0)
+		{
+			Mesh->ClearMeshSection(Section);
+			continue;
+		}
+
+		ExpandQuads(Quads, CornerLights, FirstFace, FaceCount, Origin, BlockSize, Upload);
+
+		Mesh->CreateMeshSection(
+			Section,
+			Upload.Vertices,
+			Upload.Triangles,
+			Upload.Normals,
+			Upload.UVs,
+			Upload.TextureSlices,
+			TArray<FVector2D>(),
+			TArray<FVector2D>(),
+			Upload.VertexColors,
+			TArray<FProcMeshTangent>(),
+			false
+		);
+	}
+
+	bIsMeshed = true;
+}
+
+void AChunk::SetCollisionEnabled(bool bEnabled)
+{
+	if (bCollisionEnabled == bEnabled) return;
+
+	bCollisionEnabled = bEnabled;
+	bCollisionDirty = true;
+
+	if (bEnabled) return;
+
+	//A build still running was started for the collision dropped here
+	CollisionGeneration++;
+	bCollisionInFlight = false;
+	CollisionMesh->ClearMeshSection(CollisionSection);
+}
+
+bool AChunk::IsCollisionEnabled() const
+{
+	return bCollisionEnabled;
+}
+
+TSharedPtr<FVoxelCollisionJob> AChunk::StartCollisionBuild()
+{
+	if (!bCollisionEnabled || !bCollisionDirty || bCollisionInFlight) return nullptr;
+
+	TSharedPtr<FVoxelCollisionJob> Job = MakeShared<FVoxelCollisionJob>();
+	Job->Settings = Settings;
+	Job->Blocks = Blocks;
+	Job->BorderSolid = BorderSolid;
+	Job->Origin = Origin;
+	Job->BlockSize = BlockSize;
+	Job->Width = Width;
+	Job->Height = Height;
+	Job->MinSolidZ = MinSolidZ;
+	Job->MaxSolidZ = MaxSolidZ;
+	Job->Generation = CollisionGeneration;
+
+	bCollisionDirty = false;
+	bCollisionInFlight = true;
+
+	return Job;
+}
+
+void AChunk::FinishCollisionBuild(const FVoxelCollisionJob& Job)
+{
+	//The chunk was cleared or lost its collision since the job was started
+	if (Job.Generation != CollisionGeneration) return;
+
+	bCollisionInFlight = false;
+
+	if (Job.Triangles.IsEmpty())
+	{
+		CollisionMesh->ClearMeshSection(CollisionSection);
+		return;
+	}
+
+	CollisionMesh->CreateMeshSection(
+		CollisionSection,
+		Job.Vertices,
+		Job.Triangles,
+		TArray<FVector>(),
+		TArray<FVector2D>(),
+		TArray<FColor>(),
 		TArray<FProcMeshTangent>(),
 		true
 	);
+}
 
-	EmptyMeshData();
+bool AChunk::IsMeshed() const
+{
+	return bIsMeshed;
 }
 
 void AChunk::ClearChunk()
 {
-	Mesh->ClearMeshSection(0);
-	Blocks.Empty(Width * Width * Height);
-	PotentialBlocks.Empty();
+	Mesh->ClearAllMeshSections();
+	CollisionMesh->ClearAllMeshSections();
+	EmptyMeshData();
+	bCollisionEnabled = false;
+	bCollisionDirty = true;
+	bCollisionInFlight = false;
+	CollisionGeneration++;
+	bIsMeshed = false;
+	Blocks.Reset();
+	ColumnMinZ.Reset();
+	ColumnMaxZ.Reset();
+	MinSolidZ = 0;
+	MaxSolidZ = -1;
+	SurfaceBlocks.Reset();
+	BorderSolid.Reset();
+	BorderLight.Reset();
+	bIsModified = false;
 }
 
 void AChunk::CreateChunkMeshData(bool IsGenerating)
 {
-	TArray<FVector> BlockLocs;
-	PotentialBlocks.GenerateKeyArray(BlockLocs);
-	TArray<EBlockType> BlockTypes;
-	PotentialBlocks.GenerateValueArray(BlockTypes);
+	SCOPE_CYCLE_COUNTER(STAT_VoxelChunkMeshing);
+
+	EmptyMeshData();
 
-	for (int i = 0; i < BlockLocs.Num(); i++)
+	//Chunk without solid blocks has no faces
+	if (MaxSolidZ < MinSolidZ)
 	{
-		if (BlockTypes[i] == EBlockType::Air)
+		SurfaceBlocks.ClearAll();
+		return;
+	}
+
+	FMeshingScratch& Scratch = GetMeshingScratch();
+	for (auto& SectionFaceBlocks : Scratch.FaceBlocks)
+	{
+		for (TArray<int32>& FaceBlocks : SectionFaceBlocks)
 		{
-			PotentialBlocks.Remove(BlockLocs[i]);
-			continue;
+			FaceBlocks.Reset();
 		}
+	}
+
+	//First pass sorts the exposed faces by section and direction, so the output can be sized exactly
+	SurfaceBlocks.ForEachSetBit([this, IsGenerating, &Scratch](int32 Index)
+	{
+		if (!Registry->IsSolid(Blocks[Index].Type))
+		{
+			SurfaceBlocks.Clear(Index);
+			return;
+		}
+
+		FIntVector Local = GetBlockLocal(Index);
+		int32 Section = Registry->IsTransparent(Blocks[Index].Type) ? TransparentSection : OpaqueSection;
 
 		bool IsFaceCreated = false;
-		for (int j = 0; j < Directions.Num(); j++)
+		VoxelFace::ForEachDirection([this, IsGenerating, &Scratch, &Local, &IsFaceCreated, Index, Section](auto DirectionTag)
 		{
+			constexpr EFaceDirection Direction = decltype(DirectionTag)::Value;
+
 			bool IsNextToAir = IsGenerating ?
-				IsBlockNextToAirFast(Directions[j], BlockLocs[i]) :
-				IsBlockNextToAir(Directions[j], BlockLocs[i]);
+				IsBlockNextToAirFast<Direction>(Local) :
+				IsBlockNextToAir<Direction>(Local);
 
 			if (!IsNextToAir)
-				continue;
+				return;
 
 			IsFaceCreated = true;
-			CreateFaceData(Directions[j], BlockLocs[i]);
+			Scratch.FaceBlocks[Section][static_cast<int32>(Direction)].Add(Index);
+		});
+
+		if (!IsFaceCreated)
+			SurfaceBlocks.Clear(Index);
+	});
+
+	int32 FaceCount = 0;
+	for (int32 Section = 0; Section < NumMeshSections; Section++)
+	{
+		if (Section == TransparentSection)
+			FirstTransparentQuad = FaceCount;
+
+		for (const TArray<int32>& FaceBlocks : Scratch.FaceBlocks[Section])
+		{
+			FaceCount += FaceBlocks.Num();
 		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_VoxelMeshedFaces, FaceCount);
+
+	Quads.SetNumUninitialized(FaceCount);
+
+	if (bSmoothLighting)
+		CornerLights.SetNumUninitialized(FaceCount);
+
+	SCOPE_CYCLE_COUNTER(STAT_VoxelChunkFaceData);
+
+	//Second pass writes the faces of one section and direction at a time straight into their slots
+	int32 FaceIndex = 0;
+	for (int32 Section = 0; Section < NumMeshSections; Section++)
+	{
+		VoxelFace::ForEachDirection([this, &Scratch, &FaceIndex, Section](auto DirectionTag)
+		{
+			constexpr EFaceDirection Direction = decltype(DirectionTag)::Value;
 
-		if(!IsFaceCreated)
-			PotentialBlocks.Remove(BlockLocs[i]);
+			for (int32 Index : Scratch.FaceBlocks[Section][static_cast<int32>(Direction)])
+			{
+				CreateFaceData<Direction>(GetBlockLocal(Index), Blocks[Index], FaceIndex++);
+			}
+		});
 	}
 }
 
-void AChunk::BuildLight()
+template <EFaceDirection Direction>
+void AChunk::CreateFaceData(const FIntVector& Local, const FBlock& Block, int32 FaceIndex)
+{
+	constexpr int32 Face = static_cast<int32>(Direction);
+
+	Quads.GetData()[FaceIndex] = FVoxelQuad::Pack(
+		Local.X,
+		Local.Y,
+		Local.Z,
+		Face,
+		Registry->GetFaceTexture(Block.Type, Face),
+		GetFaceLight<Direction>(Local),
+		GetFaceOcclusion<Direction>(Local)
+	);
+
+	if (bSmoothLighting)
+		CornerLights.GetData()[FaceIndex] = GetCornerLights<Direction>(Local);
+}
+
+template <EFaceDirection Direction>
+uint8 AChunk::GetFaceOcclusion(const FIntVector& Local) const
 {
-	FVector RootLocation = RootComponent->GetRelativeLocation();
+	constexpr int32 Face = static_cast<int32>(Direction);
+
+	FIntVector Front = Local + FIntVector(VoxelFace::Offsets[Face][0], VoxelFace::Offsets[Face][1], VoxelFace::Offsets[Face][2]);
+	uint8 Occlusion = 0;
 
-	for (int Z = Height * BlockSize; Z > 0; Z -= BlockSize)
+	for (int32 Corner = 0; Corner < 4; Corner++)
 	{
-		for (int Y = 0; Y < Width * BlockSize; Y += BlockSize)
-		{
-			for (int X = 0; X < Width * BlockSize; X += BlockSize)
-			{
-				FVector Position = RootLocation + FVector(X, Y, Z);
-				FBlock* Block = Blocks.Find(Position);
-				if (Block == nullptr)
-					continue;
+		FIntVector Sides[2];
+		GetCornerSides(Face, Corner, Sides);
 
-				FBlock BlockAbove;
+		bool bSide1 = IsOccluding(Front + Sides[0]);
+		bool bSide2 = IsOccluding(Front + Sides[1]);
+		bool bDiagonal = IsOccluding(Front + Sides[0] + Sides[1]);
 
-				if (!GetBlockInDirection(Position, EFaceDirection::Z, BlockAbove))
-				{
-					UE_LOG(LogTemp, Log, TEXT("Block Light: 15"));
-					Block->Light = 15;
-					continue;
-				}
+		//Two sides close the corner completely, whatever the diagonal block is
+		uint8 Level = (bSide1 && bSide2) ? 0 : 3 - (bSide1 + bSide2 + bDiagonal);
+		Occlusion |= Level << (Corner * 2);
+	}
 
-				if (BlockAbove.Type != EBlockType::Air)
-				{
-					UE_LOG(LogTemp, Log, TEXT("Block Light: 14"));
-					Block->Light = 14;
-					continue;
-				}
+	return Occlusion;
+}
 
-				if (BlockAbove.Type == EBlockType::Air && BlockAbove.Light <= 14)
-				{
-					Block->Light = BlockAbove.Light - 1;
-					UE_LOG(LogTemp, Log, TEXT("Block Light: %d"), Block->Light);
-					continue;
-				}
-			}
+template <EFaceDirection Direction>
+uint32 AChunk::GetCornerLights(const FIntVector& Local) const
+{
+	constexpr int32 Face = static_cast<int32>(Direction);
+
+	FIntVector Front = Local + FIntVector(VoxelFace::Offsets[Face][0], VoxelFace::Offsets[Face][1], VoxelFace::Offsets[Face][2]);
+	uint8 FaceLight = GetFaceLight<Direction>(Local);
+	uint32 CornerLights = 0;
+
+	for (int32 Corner = 0; Corner < 4; Corner++)
+	{
+		FIntVector Sides[2];
+		GetCornerSides(Face, Corner, Sides);
+
+		FIntVector Samples[3] = {Front + Sides[0], Front + Sides[1], Front + Sides[0] + Sides[1]};
+		bool bIsClosed = IsOccluding(Samples[0]) && IsOccluding(Samples[1]);
+
+		//The block in front of the face always counts, solid blocks and a closed off diagonal do not
+		int32 SkySum = FaceLight >> 4;
+		int32 BlockSum = FaceLight & 0x0F;
+		int32 Count = 1;
+
+		for (int32 i = 0; i < 3; i++)
+		{
+			if (i == 2 && bIsClosed) break;
+			if (IsOccluding(Samples[i])) continue;
+
+			uint8 Light = IsInsideChunk(Samples[i]) ? Blocks[GetBlockIndex(Samples[i].X, Samples[i].Y, Samples[i].Z)].Light : GetOutsideLight(Samples[i], FaceLight);
+			SkySum += Light >> 4;
+			BlockSum += Light & 0x0F;
+			Count++;
 		}
+
+		uint8 SkyLight = (SkySum + Count / 2) / Count;
+		uint8 BlockLight = (BlockSum + Count / 2) / Count;
+		CornerLights |= uint32((SkyLight << 4) | BlockLight) << (Corner * 8);
+	}
+
+	return CornerLights;
+}
+
+bool AChunk::IsOccluding(const FIntVector& Local) const
+{
+	if (IsInsideChunk(Local))
+	{
+		return Registry->IsOpaque(Blocks[GetBlockIndex(Local.X, Local.Y, Local.Z)].Type);
 	}
+
+	//Only blocks right next to one side are known, the diagonal chunks are not
+	int32 Side, Along;
+	if (BorderSolid.Num() == 0 || !GetBorderSide(Local, Side, Along))
+		return false;
+
+	return BorderSolid.Contains(FVoxelChunkBuffer::GetBorderIndex(Side, Along, Local.Z, Width, Height));
 }
 
-void AChunk::CreateFaceData(const EFaceDirection& Direction, const FVector& Position)
+bool AChunk::GetBorderSide(const FIntVector& Local, int32& OutSide, int32& OutAlong) const
 {
-	FBlock Block = *Blocks.Find(Position);
-	uint8 Index = GetTextureIndex(Block.Type);
-	FColor VertexColor = FColor(Index, Block.Light, 0, 0);
-	float HalfBlockSize = BlockSize / 2;
-	auto DirectionAsValue = GetDirectionAsValue(Direction);
+	if (Local.Z < 0 || Local.Z >= Height)
+		return false;
+
+	bool bOutsideX = Local.X < 0 || Local.X >= Width;
+	bool bOutsideY = Local.Y < 0 || Local.Y >= Width;
+	if (bOutsideX == bOutsideY)
+		return false;
+
+	if (bOutsideX)
+		OutSide = Local.X >= Width ? static_cast<int32>(EFaceDirection::X) : static_cast<int32>(EFaceDirection::nX);
+	else
+		OutSide = Local.Y >= Width ? static_cast<int32>(EFaceDirection::Y) : static_cast<int32>(EFaceDirection::nY);
+
+	OutAlong = bOutsideX ? Local.Y : Local.X;
+
+	return true;
+}
 
-	switch (Direction)
+uint8 AChunk::GetOutsideLight(const FIntVector& Local, uint8 DiagonalLight) const
+{
+	if (Local.Z < 0)
+		return 0;
+
+	if (Local.Z >= Height)
+		return FBlock::MaxLight << 4;
+
+	int32 Side, Along;
+	if (!GetBorderSide(Local, Side, Along))
+		return DiagonalLight;
+
+	if (BorderLight.Num() == FVoxelChunkBuffer::NumBorderSides * Width * Height)
+		return BorderLight[FVoxelChunkBuffer::GetBorderIndex(Side, Along, Local.Z, Width, Height)];
+
+	//Open sky above the height noise and dark below it, so cave walls on the border are not lit
+	FIntPoint WorldColumn = ChunkCoord * Width + FIntPoint(Local.X, Local.Y);
+
+	return Local.Z + 1 >= FVoxelGenerator::GetColumnHeight(*Settings, WorldColumn) ? FBlock::MaxLight << 4 : 0;
+}
+
+template <EFaceDirection Direction>
+uint8 AChunk::GetFaceLight(const FIntVector& Local) const
+{
+	constexpr int32 Face = static_cast<int32>(Direction);
+
+	FIntVector Neighbor = Local + FIntVector(VoxelFace::Offsets[Face][0], VoxelFace::Offsets[Face][1], VoxelFace::Offsets[Face][2]);
+	if (IsInsideChunk(Neighbor))
 	{
-	case EFaceDirection::X:
-		Vertices.Add(Position + FVector(HalfBlockSize, HalfBlockSize, HalfBlockSize * -1));
-		Vertices.Add(Position + FVector(HalfBlockSize, HalfBlockSize * -1, HalfBlockSize * -1));
-		Vertices.Add(Position + FVector(HalfBlockSize, HalfBlockSize, HalfBlockSize));
-		Vertices.Add(Position + FVector(HalfBlockSize, HalfBlockSize * -1, HalfBlockSize));
-		break;
-		
-	case EFaceDirection::Y:
-		Vertices.Add(Position + FVector(HalfBlockSize * -1, HalfBlockSize, HalfBlockSize * -1));
-		Vertices.Add(Position + FVector(HalfBlockSize, HalfBlockSize, HalfBlockSize * -1));
-		Vertices.Add(Position + FVector(HalfBlockSize * -1, HalfBlockSize, HalfBlockSize));
-		Vertices.Add(Position + FVector(HalfBlockSize, HalfBlockSize, HalfBlockSize));
-		break;
-
-	case EFaceDirection::nX:
-		Vertices.Add(Position + FVector(HalfBlockSize*-1, HalfBlockSize*-1, HalfBlockSize*-1));
-		Vertices.Add(Position + FVector(HalfBlockSize*-1, HalfBlockSize, HalfBlockSize*-1));
-		Vertices.Add(Position + FVector(HalfBlockSize*-1, HalfBlockSize*-1, HalfBlockSize));
-		Vertices.Add(Position + FVector(HalfBlockSize*-1, HalfBlockSize, HalfBlockSize));
-		break;
-
-	case EFaceDirection::nY:
-		Vertices.Add(Position + FVector(HalfBlockSize, HalfBlockSize*-1, HalfBlockSize*-1));
-		Vertices.Add(Position + FVector(HalfBlockSize*-1, HalfBlockSize*-1, HalfBlockSize*-1));
-		Vertices.Add(Position + FVector(HalfBlockSize, HalfBlockSize*-1, HalfBlockSize));
-		Vertices.Add(Position + FVector(HalfBlockSize*-1, HalfBlockSize*-1, HalfBlockSize));
-		break;
-
-	case EFaceDirection::nZ:
-		Vertices.Add(Position + FVector(HalfBlockSize * -1, HalfBlockSize, HalfBlockSize * -1));
-		Vertices.Add(Position + FVector(HalfBlockSize * -1, HalfBlockSize * -1, HalfBlockSize * -1));
-		Vertices.Add(Position + FVector(HalfBlockSize, HalfBlockSize, HalfBlockSize * -1));
-		Vertices.Add(Position + FVector(HalfBlockSize, HalfBlockSize * -1, HalfBlockSize * -1));
-		break;
-
-	case EFaceDirection::Z:
-		Vertices.Add(Position + FVector(HalfBlockSize, HalfBlockSize, HalfBlockSize));
-		Vertices.Add(Position + FVector(HalfBlockSize, HalfBlockSize * -1, HalfBlockSize));
-		Vertices.Add(Position + FVector(HalfBlockSize * -1, HalfBlockSize, HalfBlockSize));
-		Vertices.Add(Position + FVector(HalfBlockSize * -1, HalfBlockSize * -1, HalfBlockSize));
-		break;
+		return Blocks[GetBlockIndex(Neighbor.X, Neighbor.Y, Neighbor.Z)].Light;
 	}
 
-	VertexColors.Append({
-		VertexColor,
-		VertexColor,
-		VertexColor,
-		VertexColor
-	});
-	Normals.Append({
-		DirectionAsValue,
-		DirectionAsValue,
-		DirectionAsValue,
-		DirectionAsValue
-	});
-	UVs.Append({
-		FVector2D(0, 0),
-		FVector2D(0, 1),
-		FVector2D(1, 0),
-		FVector2D(1, 1)
-	});
-	Triangles.Append({
-		Vertices.Num() - 4,
-		Vertices.Num() - 3,
-		Vertices.Num() - 2,
-		Vertices.Num() - 2,
-		Vertices.Num() - 3,
-		Vertices.Num() - 1
-	});
+	return GetOutsideLight(Neighbor, 0);
 }
 
-void AChunk::AddPotentialBlocksAround(const FVector& BlockPosition)
+void AChunk::AddPotentialBlocksAround(const FIntVector& Local, TSet<IChunkable*>& OutNeighbors)
 {
 	for (int32 XOffset = -1; XOffset <= 1; XOffset++)
 	{
@@ -309,93 +728,211 @@ void AChunk::AddPotentialBlocksAround(const FVector& BlockPosition)
 				if (XOffset == 0 && YOffset == 0 && ZOffset == 0)
 					continue;
 
-				FVector NeighborPosition = BlockPosition + FVector(XOffset, YOffset, ZOffset) * BlockSize;
+				FIntVector NeighborLocal = Local + FIntVector(XOffset, YOffset, ZOffset);
+				FVector NeighborPosition = LocalToWorld(NeighborLocal);
 
-				if (Blocks.Contains(NeighborPosition))
+				if (IsInsideChunk(NeighborLocal))
 				{
-					FBlock& NeighborBlock = Blocks[NeighborPosition];
-					PotentialBlocks.Add(NeighborPosition, NeighborBlock.Type);
+					SurfaceBlocks.Set(GetBlockIndex(NeighborLocal.X, NeighborLocal.Y, NeighborLocal.Z));
 					continue;
 				}
 
-				Manager.Get()->AddPotentialBlockAndRebuild(GetActorLocation() + FVector(XOffset, YOffset, ZOffset) * BlockSize * Width, NeighborPosition);
+				IChunkable* Neighbor = Manager.Get()->AddPotentialBlock(GetActorLocation() + FVector(XOffset, YOffset, ZOffset) * BlockSize * Width, NeighborPosition);
+				if (Neighbor)
+					OutNeighbors.Add(Neighbor);
 			}
 		}
 	}
 }
 
-bool AChunk::IsBlockNextToAirFast(const EFaceDirection& Direction, const FVector& Position) const
+template <EFaceDirection Direction>
+bool AChunk::IsBlockNextToAirFast(const FIntVector& Local) const
 {
-	FVector BlockInDirection = (GetDirectionAsValue(Direction) * BlockSize + Position).GridSnap(BlockSize);
-	if (Blocks.Find(BlockInDirection) != nullptr)
+	constexpr int32 Face = static_cast<int32>(Direction);
+
+	FIntVector Neighbor = Local + FIntVector(VoxelFace::Offsets[Face][0], VoxelFace::Offsets[Face][1], VoxelFace::Offsets[Face][2]);
+	if (IsInsideChunk(Neighbor))
+	{
+		EBlockType Type = Blocks[GetBlockIndex(Local.X, Local.Y, Local.Z)].Type;
+		return Registry->IsFaceVisible(Type, Blocks[GetBlockIndex(Neighbor.X, Neighbor.Y, Neighbor.Z)].Type);
+	}
+
+	if (Neighbor.Z < 0 || Neighbor.Z >= Height)
+		return Neighbor.Z >= Height;
+
+	//Only the four sides leave the chunk here, their face index is the border side
+	if (BorderSolid.Num() > 0)
 	{
-		return Blocks[BlockInDirection].Type == EBlockType::Air;
+		int32 Along = (Direction == EFaceDirection::X || Direction == EFaceDirection::nX) ? Neighbor.Y : Neighbor.X;
+		return !BorderSolid.Contains(FVoxelChunkBuffer::GetBorderIndex(Face, Along, Neighbor.Z, Width, Height));
 	}
 
-	float BlockHeight = Noise->GetNoise(BlockInDirection.X / 100, BlockInDirection.Y / 100);
-	BlockHeight = LimitNoise(BlockHeight, 6, 32);
+	//Loaded chunks have no border data, without 3D stages the height noise is exact
+	if (Settings->bHasVolumetricStages)
+		return true;
+
+	FIntPoint WorldColumn = ChunkCoord * Width + FIntPoint(Neighbor.X, Neighbor.Y);
 
-	return (BlockInDirection.Z / BlockSize) >= BlockHeight;
+	return Neighbor.Z + 1 >= FVoxelGenerator::GetColumnHeight(*Settings, WorldColumn);
 }
 
-bool AChunk::IsBlockNextToAir(const EFaceDirection& Direction, const FVector& Position) const
+template <EFaceDirection Direction>
+bool AChunk::IsBlockNextToAir(const FIntVector& Local) const
 {
-	FVector BlockInDirection = (GetDirectionAsValue(Direction) * BlockSize + Position).GridSnap(BlockSize);
-	if (Blocks.Find(BlockInDirection) != nullptr)
+	constexpr int32 Face = static_cast<int32>(Direction);
+
+	FIntVector Offset = FIntVector(VoxelFace::Offsets[Face][0], VoxelFace::Offsets[Face][1], VoxelFace::Offsets[Face][2]);
+	FIntVector Neighbor = Local + Offset;
+	EBlockType Type = Blocks[GetBlockIndex(Local.X, Local.Y, Local.Z)].Type;
+	if (IsInsideChunk(Neighbor))
 	{
-		return Blocks[BlockInDirection].Type == EBlockType::Air;
+		return Registry->IsFaceVisible(Type, Blocks[GetBlockIndex(Neighbor.X, Neighbor.Y, Neighbor.Z)].Type);
 	}
 
-	return Manager.Get()->IsBlockAir(GetActorLocation() + GetDirectionAsValue(Direction) * BlockSize * Width, BlockInDirection);
+	return Manager.Get()->IsFaceVisible(GetActorLocation() + FVector(Offset) * BlockSize * Width, LocalToWorld(Neighbor), Type);
 }
 
-uint8 AChunk::GetTextureIndex(const EBlockType& Type) const
+void AChunk::AddPotentialBlock(const FVector& Position)
 {
-	return static_cast<uint8>(Type) - 1;
+	FIntVector Local;
+	if (!WorldToLocal(Position, Local)) return;
+
+	SurfaceBlocks.Set(GetBlockIndex(Local.X, Local.Y, Local.Z));
 }
 
-void AChunk::AddPotentialBlock(const FVector& Position)
+FBlock* AChunk::GetBlock(const FVector& Position)
 {
-	auto Block = Blocks.Find(Position.GridSnap(BlockSize));
-	if (!Block) return;
+	FIntVector Local;
+	if (!WorldToLocal(Position, Local)) return nullptr;
 
-	PotentialBlocks.Add(Position, Block->Type);
+	return &Blocks[GetBlockIndex(Local.X, Local.Y, Local.Z)];
+}
+
+const TArray<FBlock>& AChunk::GetBlocks() const
+{
+	return Blocks;
 }
 
-TMap<FVector, FBlock>& AChunk::GetBlocks()
+TArray<FBlock>& AChunk::GetMutableBlocks()
 {
 	return Blocks;
 }
 
+const FVoxelBitset& AChunk::GetBorderSolid() const
+{
+	return BorderSolid;
+}
+
+bool AChunk::IsModified() const
+{
+	return bIsModified;
+}
+
 void AChunk::LogBlocks()
 {
-	for (const auto& Elem : Blocks)
+	for (int32 Y = 0; Y < Width; Y++)
 	{
-		FVector Key = Elem.Key;
-		const FBlock& Block = Elem.Value;
+		for (int32 X = 0; X < Width; X++)
+		{
+			for (int32 Z = 0; Z < Height; Z++)
+			{
+				FVector Key = LocalToWorld(FIntVector(X, Y, Z));
 
-		UE_LOG(LogTemp, Log, TEXT("Block Location: X=%f, Y=%f, Z=%f"), Key.X, Key.Y, Key.Z);
+				UE_LOG(LogTemp, Log, TEXT("Block Location: X=%f, Y=%f, Z=%f"), Key.X, Key.Y, Key.Z);
+			}
+		}
 	}
 }
 
-float AChunk::LimitNoise(float NoiseValue, int MinHeight, int MaxHeight) const
+void AChunk::UpdateOrigin()
+{
+	Origin = RootComponent->GetRelativeLocation();
+	ChunkCoord = FIntPoint(
+		FMath::RoundToInt32(Origin.X / (BlockSize * Width)),
+		FMath::RoundToInt32(Origin.Y / (BlockSize * Width))
+	);
+}
+
+int32 AChunk::GetBlockIndex(int32 X, int32 Y, int32 Z) const
+{
+	return Z + Height * (X + Width * Y);
+}
+
+FIntVector AChunk::GetBlockLocal(int32 Index) const
+{
+	int32 Column = Index / Height;
+
+	return FIntVector(Column % Width, Column / Width, Index % Height);
+}
+
+bool AChunk::IsInsideChunk(const FIntVector& Local) const
+{
+	return Local.X >= 0 && Local.X < Width &&
+		Local.Y >= 0 && Local.Y < Width &&
+		Local.Z >= 0 && Local.Z < Height;
+}
+
+bool AChunk::WorldToLocal(const FVector& Position, FIntVector& OutLocal) const
 {
-	float normalizedValue = (NoiseValue + 1.0f) / 2.0f;
-	int voxelHeight = static_cast<int>(normalizedValue * (MaxHeight - MinHeight) + MinHeight);
+	if (Blocks.IsEmpty()) return false;
+
+	FVector Offset = (Position - Origin) / BlockSize;
+	OutLocal = FIntVector(
+		FMath::RoundToInt32(Offset.X),
+		FMath::RoundToInt32(Offset.Y),
+		FMath::RoundToInt32(Offset.Z) - 1
+	);
 
-	voxelHeight = FMath::Clamp(voxelHeight, MinHeight, MaxHeight);
+	return IsInsideChunk(OutLocal);
+}
 
-	return voxelHeight;
+FVector AChunk::LocalToWorld(const FIntVector& Local) const
+{
+	return Origin + FVector(Local.X, Local.Y, Local.Z + 1) * BlockSize;
+}
+
+void AChunk::UpdateColumnBounds(int32 X, int32 Y)
+{
+	int32 Column = X + Width * Y;
+	ColumnMinZ[Column] = Height;
+	ColumnMaxZ[Column] = -1;
+
+	for (int32 Z = 0; Z < Height; Z++)
+	{
+		if (!Registry->IsSolid(Blocks[GetBlockIndex(X, Y, Z)].Type)) continue;
+
+		ColumnMinZ[Column] = FMath::Min<int32>(ColumnMinZ[Column], Z);
+		ColumnMaxZ[Column] = Z;
+	}
+}
+
+void AChunk::UpdateChunkBounds()
+{
+	MinSolidZ = Height;
+	MaxSolidZ = -1;
+
+	for (int32 Column = 0; Column < ColumnMinZ.Num(); Column++)
+	{
+		MinSolidZ = FMath::Min<int32>(MinSolidZ, ColumnMinZ[Column]);
+		MaxSolidZ = FMath::Max<int32>(MaxSolidZ, ColumnMaxZ[Column]);
+	}
 }
 
 bool AChunk::GetBlockInDirection(const FVector& Position, const EFaceDirection& Direction, FBlock& Block) const
 {
 	FVector BlockInDirection = (GetDirectionAsValue(Direction) * BlockSize + Position).GridSnap(BlockSize);
 	
-	if (Blocks.Find(BlockInDirection) != nullptr)
+	FIntVector Local;
+	if (WorldToLocal(BlockInDirection, Local))
 	{
-		Manager->AddPotentialBlockAndRebuild(GetActorLocation() + GetDirectionAsValue(Direction) * BlockSize * Width, BlockInDirection);
-		Block = *Blocks.Find(BlockInDirection);
+		IChunkable* Neighbor = Manager->AddPotentialBlock(GetActorLocation() + GetDirectionAsValue(Direction) * BlockSize * Width, BlockInDirection);
+		if (Neighbor)
+		{
+			Neighbor->CaptureBorderLight();
+			Neighbor->CreateChunkMesh(false);
+			Neighbor->ApplyMesh();
+		}
+		Block = Blocks[GetBlockIndex(Local.X, Local.Y, Local.Z)];
 		return true;
 	}
 
@@ -404,25 +941,19 @@ bool AChunk::GetBlockInDirection(const FVector& Position, const EFaceDirection&
 
 void AChunk::EmptyMeshData()
 {
-	Vertices.Empty();
-	UVs.Empty();
-	Normals.Empty();
-	Triangles.Empty();
-	VertexColors.Empty();
+	Quads.Reset();
+	FirstTransparentQuad = 0;
+	CornerLights.Reset();
 }
 
 FVector AChunk::GetDirectionAsValue(const EFaceDirection& Direction) const
 {
-	TArray<FVector> Dire = {
-		FVector(1, 0, 0),
-		FVector(0, 1, 0),
-		FVector(-1, 0, 0),
-		FVector(0, -1, 0),
-		FVector(0, 0, -1),
-		FVector(0, 0, 1)
-	};
+	return FVector(GetDirectionAsOffset(Direction));
+}
 
+FIntVector AChunk::GetDirectionAsOffset(const EFaceDirection& Direction) const
+{
 	int32 Index = static_cast<int32>(Direction);
 
-	return Dire[Index];
+	return FIntVector(VoxelFace::Offsets[Index][0], VoxelFace::Offsets[Index][1], VoxelFace::Offsets[Index][2]);
 }
@@ -3,6 +3,8 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "../../Structs/Block.h"
+#include "../../Structs/VoxelBitset.h"
+#include "../../Structs/VoxelQuad.h"
 #include "../../Interfaces/Chunkable.h"
 #include "Chunk.generated.h"
 
@@ -10,9 +12,12 @@ struct FBlock;
 enum class EFaceDirection;
 enum class EBlockType : uint8;
 class UProceduralMeshComponent;
-class FastNoiseLite;
+struct FVoxelGenerationSettings;
+class FVoxelBlockRegistry;
 class AChunkManager;
 class USceneComponent;
+class UMaterialInterface;
+struct FVoxelCollisionJob;
 
 /**
  * Chunk of blocks
@@ -35,17 +40,74 @@ public:
 	UPROPERTY(BlueprintReadWrite, VisibleAnywhere, Category = "Components")
 	TObjectPtr<UProceduralMeshComponent> Mesh;
 
-	TSharedPtr<FastNoiseLite> Noise;
+	/**
+	 * Holds only the collision, built from merged faces instead of the render mesh.
+	 * A procedural mesh cooks all its collision again whenever any of its sections changes,
+	   so keeping it apart means rebuilding the render mesh never cooks collision.
+	 */
+	UPROPERTY(VisibleAnywhere, Category = "Components")
+	TObjectPtr<UProceduralMeshComponent> CollisionMesh;
+
+	/**
+	 * Material of the transparent blocks, drawn in their own mesh section so the opaque
+	   section keeps early depth testing and only the few transparent faces are sorted.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Chunk")
+	TObjectPtr<UMaterialInterface> TransparentMaterial;
+
+	static constexpr int32 OpaqueSection = 0;
+	static constexpr int32 TransparentSection = 1;
+	static constexpr int32 NumMeshSections = 2;
+
+	//Only section of CollisionMesh
+	static constexpr int32 CollisionSection = 0;
+
+	TSharedPtr<const FVoxelGenerationSettings> Settings;
+
+	//Block types of Settings, kept for lookups in per block loops
+	const FVoxelBlockRegistry* Registry;
 	TObjectPtr<AChunkManager> Manager;
 	int32 BlockSize;
 	int32 Width;
 	int32 Height;
 
-	//All Blocks in a chunk
-	TMap<FVector, FBlock> Blocks;
+	//World location of the chunk the blocks were generated at
+	FVector Origin;
+
+	//Position of the chunk in chunk units
+	FIntPoint ChunkCoord;
+
+	//All Blocks in a chunk, stored column by column (Z changes fastest)
+	TArray<FBlock> Blocks;
+
+	//Lowest and highest solid block of every column. Empty columns have Min > Max
+	TArray<int16> ColumnMinZ;
+	TArray<int16> ColumnMaxZ;
 
-	//Blocks that will most likely have faces
-	TMap<FVector, EBlockType> PotentialBlocks;
+	//Lowest and highest solid block of the whole chunk
+	int32 MinSolidZ;
+	int32 MaxSolidZ;
+
+	//Blocks that will most likely have faces, one bit per entry in Blocks
+	FVoxelBitset SurfaceBlocks;
+
+	//Solid blocks right outside the chunk as given by the generator, see FVoxelChunkBuffer::BorderSolid
+	FVoxelBitset BorderSolid;
+
+	//Light right outside the chunk as captured from the neighbours, laid out like BorderSolid. Empty when not captured
+	TArray<uint8> BorderLight;
+
+	//Whether blocks were changed since the chunk was generated or loaded
+	bool bIsModified;
+
+	//Whether vertices average the light around them instead of taking the light of their face
+	bool bSmoothLighting;
+
+	//Whether the chunk is close enough to a player to need collision
+	bool bCollisionEnabled;
+
+	//Whether a mesh was applied since the chunk was last cleared
+	bool bIsMeshed;
 
 	/**
 	 * Sets Chunk Instance with essential data for chunks.
@@ -60,18 +122,53 @@ public:
 	/**
 	 * Generates the chunk data based on noise. It does not create the mesh.
 	 */
-	void GenerateChunk(const TSharedPtr<FastNoiseLite>& InNoise) override;
+	void GenerateChunk(const TSharedPtr<const FVoxelGenerationSettings>& InSettings) override;
+
+	/**
+	 * Sets the chunk data from previously saved blocks instead of generating it.
+	 */
+	void LoadChunk(const TSharedPtr<const FVoxelGenerationSettings>& InSettings, TArray<FBlock>&& InBlocks, FVoxelBitset&& InBorderSolid) override;
 
 	/**
 	 * Creates the data for the mesh for the chunk using the generated chunk data.
 	 */
 	void CreateChunkMesh(bool IsGenerating) override;
 
+	/**
+	 * Copies the light right around the chunk from its neighbours through the manager.
+	 */
+	void CaptureBorderLight() override;
+
 	/**
 	 * Creates chunk mesh based on data created.
 	 */
 	void ApplyMesh() override;
 
+	/**
+	 * Turns collision on or off, see IChunkable::SetCollisionEnabled.
+	 */
+	void SetCollisionEnabled(bool bEnabled) override;
+
+	/**
+	 * Returns true if the chunk builds collision.
+	 */
+	bool IsCollisionEnabled() const override;
+
+	/**
+	 * Copies the blocks into a collision job, see IChunkable::StartCollisionBuild.
+	 */
+	TSharedPtr<FVoxelCollisionJob> StartCollisionBuild() override;
+
+	/**
+	 * Uploads the merged collision faces of a job into CollisionMesh.
+	 */
+	void FinishCollisionBuild(const FVoxelCollisionJob& Job) override;
+
+	/**
+	 * Returns true if a mesh was applied since the chunk was last cleared.
+	 */
+	bool IsMeshed() const override;
+
 	/**
 	 * Destroys chunk, mesh and all the data with it.
 	 */
@@ -89,66 +186,176 @@ public:
 	void AddPotentialBlock(const FVector& Position) override;
 
 	/**
-	 * Returns all blocks in this chunk.
+	 * Returns the block at a world position, or nullptr if it is not in this chunk.
+	 */
+	FBlock* GetBlock(const FVector& Position) override;
+
+	/**
+	 * Returns all blocks in this chunk, empty if the chunk has no data yet.
+	 */
+	const TArray<FBlock>& GetBlocks() const override;
+
+	/**
+	 * Returns all blocks in this chunk for changes that keep their types, like light updates.
+	 */
+	TArray<FBlock>& GetMutableBlocks() override;
+
+	/**
+	 * Returns which blocks right around the chunk are solid, empty if not known.
 	 */
-	TMap<FVector, FBlock>& GetBlocks() override;
+	const FVoxelBitset& GetBorderSolid() const override;
+
+	/**
+	 * Returns true if blocks were changed since the chunk was generated or loaded.
+	 */
+	bool IsModified() const override;
 
 	void LogBlocks();
 
 protected:
-	TArray<FVector> Vertices;
-	TArray<FVector> Normals;
-	TArray<FVector2D> UVs;
-	TArray<int32> Triangles;
-	TArray<FColor> VertexColors;
+	//Faces of the chunk mesh in packed form, expanded to vertices only when uploaded.
+	//Opaque faces come first, transparent ones start at FirstTransparentQuad
+	TArray<FVoxelQuad> Quads;
+	int32 FirstTransparentQuad;
+
+	//Smoothed light of every quad, 8 bits per corner packed like FBlock::Light. Empty without smooth lighting
+	TArray<uint32> CornerLights;
+
+	//Whether blocks changed since the last collision build was started
+	bool bCollisionDirty;
 
-	TArray<EFaceDirection> Directions;
+	//Whether a collision job is running, only one runs per chunk at a time
+	bool bCollisionInFlight;
+
+	//Bumped whenever the chunk is cleared or drops its collision, so results of older jobs are thrown away
+	uint32 CollisionGeneration;
 
 	/**
 	 * Generates the chunk's mesh data (vertices, triangles, normals, UVs).
 	 */
 	void CreateChunkMeshData(bool IsGenerating);
 
-	void BuildLight();
+	/**
+	 * Marks every solid block next to air as a surface block, using the column bounds.
+	 */
+	void FindSurfaceBlocks();
+
+	/**
+	 * Writes a single face of a block into the already sized quad array at FaceIndex.
+	 */
+	template <EFaceDirection Direction>
+	void CreateFaceData(const FIntVector& Local, const FBlock& Block, int32 FaceIndex);
+
+	/**
+	 * Light of the block a face looks into, packed like FBlock::Light.
+	 * Blocks outside the chunk are read from BorderLight, above the chunk they are always open sky.
+	 */
+	template <EFaceDirection Direction>
+	uint8 GetFaceLight(const FIntVector& Local) const;
+
+	/**
+	 * Light of a block outside the chunk. The diagonal chunks are not captured, blocks there get DiagonalLight.
+	 * Without captured light it is estimated from the height noise.
+	 */
+	uint8 GetOutsideLight(const FIntVector& Local, uint8 DiagonalLight) const;
+
+	/**
+	 * Border side and position along it of a block right outside one side of the chunk, see FVoxelChunkBuffer::GetBorderIndex.
+	 * Returns false for blocks above, below or diagonal to the chunk.
+	 */
+	bool GetBorderSide(const FIntVector& Local, int32& OutSide, int32& OutAlong) const;
+
+	/**
+	 * Ambient occlusion of the four corners of a face, packed like FVoxelQuad stores it.
+	 * Each corner is darkened by the solid blocks among the three in front of the face touching it.
+	 */
+	template <EFaceDirection Direction>
+	uint8 GetFaceOcclusion(const FIntVector& Local) const;
+
+	/**
+	 * Whether a block darkens the corners next to it. Blocks outside the chunk are only known
+	   right next to its sides, from the border data given by the generator.
+	 */
+	bool IsOccluding(const FIntVector& Local) const;
 
 	/**
-	 * Creates the vertex, normal, and triangle data for a single face of a block.
+	 * Light of the four corners of a face for smooth lighting, 8 bits per corner.
+	 * Every corner averages the light of the open blocks in front of the face touching it.
 	 */
-	void CreateFaceData(const EFaceDirection& Direction, const FVector& Position);
+	template <EFaceDirection Direction>
+	uint32 GetCornerLights(const FIntVector& Local) const;
 
 	/**
 	 * Adds all potential blocks in all directions that might have faces around a block position.
+	 * Neighbouring chunks that got one are added to OutNeighbors, to be rebuilt by the caller.
 	 */
-	void AddPotentialBlocksAround(const FVector& BlockPosition);
+	void AddPotentialBlocksAround(const FIntVector& Local, TSet<IChunkable*>& OutNeighbors);
 
 	/**
-	 * Checks whether a block face is adjacent to an air block (empty space).
+	 * Checks whether a block face is adjacent to a block it can be seen through, see FVoxelBlockRegistry::IsFaceVisible.
 	 * 
 	 * Checks it based on Noise. Is only used when generating chunk for the first time.
 	 */
-	bool IsBlockNextToAirFast(const EFaceDirection& Direction, const FVector& Position) const;
+	template <EFaceDirection Direction>
+	bool IsBlockNextToAirFast(const FIntVector& Local) const;
 
 	/**
-	 * Checks whether a block face is adjacent to an air block (empty space).
+	 * Checks whether a block face is adjacent to a block it can be seen through, see FVoxelBlockRegistry::IsFaceVisible.
 	 * 
 	 * Checks it based on actuall blocks in chunks.
 	 */
-	bool IsBlockNextToAir(const EFaceDirection& Direction, const FVector& Position) const;
+	template <EFaceDirection Direction>
+	bool IsBlockNextToAir(const FIntVector& Local) const;
 
 	/**
-	 * Gets the index for FColor from blocktype
+	 * Gets the vector value representing the direction of a block face.
 	 */
-	uint8 GetTextureIndex(const EBlockType& Type) const;
+	FVector GetDirectionAsValue(const EFaceDirection& Direction) const;
 
 	/**
-	 * Gets the vector value representing the direction of a block face.
+	 * Gets the integer offset to the neighbouring block in a direction.
 	 */
-	FVector GetDirectionAsValue(const EFaceDirection& Direction) const;
+	FIntVector GetDirectionAsOffset(const EFaceDirection& Direction) const;
+
+	/**
+	 * Sets Origin and ChunkCoord from the current actor location.
+	 */
+	void UpdateOrigin();
+
+	/**
+	 * Index of a local block position in Blocks.
+	 */
+	int32 GetBlockIndex(int32 X, int32 Y, int32 Z) const;
+
+	/**
+	 * Local block position of an index in Blocks.
+	 */
+	FIntVector GetBlockLocal(int32 Index) const;
+
+	/**
+	 * Whether a local block position lies inside this chunk.
+	 */
+	bool IsInsideChunk(const FIntVector& Local) const;
+
+	/**
+	 * Converts a world position to a local block position. Returns false if it is not in this chunk.
+	 */
+	bool WorldToLocal(const FVector& Position, FIntVector& OutLocal) const;
+
+	/**
+	 * Converts a local block position to the world position of the block.
+	 */
+	FVector LocalToWorld(const FIntVector& Local) const;
+
+	/**
+	 * Rescans a column for its lowest and highest solid block.
+	 */
+	void UpdateColumnBounds(int32 X, int32 Y);
 
 	/**
-	 * Limits the noise value to within a specified height range.
+	 * Recomputes the chunk bounds from the column bounds.
 	 */
-	float LimitNoise(float NoiseValue, int MinHeight, int MaxHeight) const;
+	void UpdateChunkBounds();
 
 	/**
 	 * Returns block in given direction relative to certain block.
@@ -156,7 +363,8 @@ protected:
 	bool GetBlockInDirection(const FVector& Position, const EFaceDirection& Direction, FBlock& Block) const;
 
 	/**
-	 * Empties arrays with vertex, normal, and triangle data
+	 * Empties the packed mesh data.
+	 * Keeps its memory, so pooled chunks rebuild without reallocating.
 	 */
 	void EmptyMeshData();
 };
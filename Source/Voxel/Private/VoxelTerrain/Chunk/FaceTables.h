@@ -0,0 +1,64 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/IntegralConstant.h"
+#include "../../Enums/Direction.h"
+
+/**
+ * Constant per-direction data for block faces, indexed by EFaceDirection.
+ */
+namespace VoxelFace
+{
+	constexpr int32 NumDirections = 6;
+
+	//Offset to the neighbouring block, which is also the face normal
+	constexpr int8 Offsets[NumDirections][3] = {
+		{ 1,  0,  0},
+		{ 0,  1,  0},
+		{-1,  0,  0},
+		{ 0, -1,  0},
+		{ 0,  0, -1},
+		{ 0,  0,  1},
+	};
+
+	//Corners of a face relative to the block center, in half block units
+	constexpr int8 Corners[NumDirections][4][3] = {
+		{{ 1,  1, -1}, { 1, -1, -1}, { 1,  1,  1}, { 1, -1,  1}},
+		{{-1,  1, -1}, { 1,  1, -1}, {-1,  1,  1}, { 1,  1,  1}},
+		{{-1, -1, -1}, {-1,  1, -1}, {-1, -1,  1}, {-1,  1,  1}},
+		{{ 1, -1, -1}, {-1, -1, -1}, { 1, -1,  1}, {-1, -1,  1}},
+		{{-1,  1, -1}, {-1, -1, -1}, { 1,  1, -1}, { 1, -1, -1}},
+		{{ 1,  1,  1}, { 1, -1,  1}, {-1,  1,  1}, {-1, -1,  1}},
+	};
+
+	constexpr int8 CornerUVs[4][2] = {
+		{0, 0},
+		{0, 1},
+		{1, 0},
+		{1, 1},
+	};
+
+	//Two triangles of a face as corner indices
+	constexpr int32 TriangleCorners[6] = {0, 1, 2, 2, 1, 3};
+
+	//Same face split along the other diagonal, with the same winding
+	constexpr int32 FlippedTriangleCorners[6] = {0, 1, 3, 0, 3, 2};
+
+	template <EFaceDirection Direction>
+	using TDirection = TIntegralConstant<EFaceDirection, Direction>;
+
+	/**
+	 * Calls Func once per direction with the direction as a compile time constant,
+	   so the body can be specialized per direction.
+	 */
+	template <typename FuncType>
+	FORCEINLINE void ForEachDirection(FuncType&& Func)
+	{
+		Func(TDirection<EFaceDirection::X>());
+		Func(TDirection<EFaceDirection::Y>());
+		Func(TDirection<EFaceDirection::nX>());
+		Func(TDirection<EFaceDirection::nY>());
+		Func(TDirection<EFaceDirection::nZ>());
+		Func(TDirection<EFaceDirection::Z>());
+	}
+}
@@ -0,0 +1,187 @@
+#include "VoxelTerrain/Chunk/VoxelCollisionJob.h"
+#include "Voxel.h"
+#include "FaceTables.h"
+#include "../../Structs/VoxelChunkBuffer.h"
+#include "../Generation/VoxelGenerator.h"
+#include "../Blocks/VoxelBlockRegistry.h"
+
+namespace
+{
+	/**
+	 * Faces of one collision slice that are not merged into a rectangle yet.
+	 * Every thread keeps its own, so jobs running on it reuse the memory.
+	 */
+	TArray<bool>& GetCollisionMask()
+	{
+		static thread_local TArray<bool> Mask;
+		return Mask;
+	}
+
+	/**
+	 * Axis a face points along.
+	 */
+	int32 GetFaceAxis(int32 Face)
+	{
+		return VoxelFace::Offsets[Face][0] != 0 ? 0 : (VoxelFace::Offsets[Face][1] != 0 ? 1 : 2);
+	}
+}
+
+void FVoxelCollisionJob::Build()
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelChunkCollision);
+
+	Vertices.Reset();
+	Triangles.Reset();
+
+	if (MaxSolidZ < MinSolidZ) return;
+
+	//Only the solid height range of the chunk can have faces
+	int32 Size[3] = {Width, Width, MaxSolidZ - MinSolidZ + 1};
+	TArray<bool>& Mask = GetCollisionMask();
+
+	for (int32 Face = 0; Face < VoxelFace::NumDirections; Face++)
+	{
+		int32 Axis = GetFaceAxis(Face);
+		int32 U = (Axis + 1) % 3;
+		int32 V = (Axis + 2) % 3;
+		int32 SizeU = Size[U];
+		int32 SizeV = Size[V];
+
+		Mask.SetNumUninitialized(SizeU * SizeV);
+
+		for (int32 Slice = 0; Slice < Size[Axis]; Slice++)
+		{
+			for (int32 MaskV = 0; MaskV < SizeV; MaskV++)
+			{
+				for (int32 MaskU = 0; MaskU < SizeU; MaskU++)
+				{
+					FIntVector Local;
+					Local[Axis] = Slice;
+					Local[U] = MaskU;
+					Local[V] = MaskV;
+					Local.Z += MinSolidZ;
+
+					Mask[MaskU + SizeU * MaskV] = IsCollisionFace(Local, Face);
+				}
+			}
+
+			//Grows every face first along U, then along V while the whole row is set
+			for (int32 MaskV = 0; MaskV < SizeV; MaskV++)
+			{
+				for (int32 MaskU = 0; MaskU < SizeU; MaskU++)
+				{
+					if (!Mask[MaskU + SizeU * MaskV]) continue;
+
+					int32 QuadWidth = 1;
+					while (MaskU + QuadWidth < SizeU && Mask[MaskU + QuadWidth + SizeU * MaskV])
+					{
+						QuadWidth++;
+					}
+
+					int32 QuadHeight = 1;
+					for (; MaskV + QuadHeight < SizeV; QuadHeight++)
+					{
+						bool bIsRowSet = true;
+						for (int32 i = 0; i < QuadWidth && bIsRowSet; i++)
+						{
+							bIsRowSet = Mask[MaskU + i + SizeU * (MaskV + QuadHeight)];
+						}
+
+						if (!bIsRowSet) break;
+					}
+
+					for (int32 j = 0; j < QuadHeight; j++)
+					{
+						for (int32 i = 0; i < QuadWidth; i++)
+						{
+							Mask[MaskU + i + SizeU * (MaskV + j)] = false;
+						}
+					}
+
+					float BaseU = U == 2 ? MinSolidZ : 0;
+					float BaseV = V == 2 ? MinSolidZ : 0;
+					float Plane = (Axis == 2 ? Slice + MinSolidZ : Slice) + VoxelFace::Offsets[Face][Axis] * 0.5f;
+
+					AddQuad(
+						Face,
+						Plane,
+						BaseU + MaskU - 0.5f,
+						BaseV + MaskV - 0.5f,
+						BaseU + MaskU + QuadWidth - 0.5f,
+						BaseV + MaskV + QuadHeight - 0.5f
+					);
+				}
+			}
+		}
+	}
+}
+
+bool FVoxelCollisionJob::IsCollisionFace(const FIntVector& Local, int32 Face) const
+{
+	const FVoxelBlockRegistry& Registry = *Settings->Blocks;
+
+	if (!Registry.IsCollidable(Blocks[GetBlockIndex(Local.X, Local.Y, Local.Z)].Type))
+		return false;
+
+	FIntVector Neighbor = Local + FIntVector(VoxelFace::Offsets[Face][0], VoxelFace::Offsets[Face][1], VoxelFace::Offsets[Face][2]);
+	bool bIsInsideChunk = Neighbor.X >= 0 && Neighbor.X < Width &&
+		Neighbor.Y >= 0 && Neighbor.Y < Width &&
+		Neighbor.Z >= 0 && Neighbor.Z < Height;
+
+	if (bIsInsideChunk)
+	{
+		return !Registry.IsCollidable(Blocks[GetBlockIndex(Neighbor.X, Neighbor.Y, Neighbor.Z)].Type);
+	}
+
+	if (Neighbor.Z < 0 || Neighbor.Z >= Height)
+		return Neighbor.Z >= Height;
+
+	if (BorderSolid.Num() == 0)
+		return true;
+
+	//Only the four sides leave the chunk here, their face index is the border side
+	int32 Along = GetFaceAxis(Face) == 0 ? Neighbor.Y : Neighbor.X;
+
+	return !BorderSolid.Contains(FVoxelChunkBuffer::GetBorderIndex(Face, Along, Neighbor.Z, Width, Height));
+}
+
+void FVoxelCollisionJob::AddQuad(int32 Face, float Plane, float MinU, float MinV, float MaxU, float MaxV)
+{
+	int32 Axis = GetFaceAxis(Face);
+	int32 U = (Axis + 1) % 3;
+	int32 V = (Axis + 2) % 3;
+
+	FVector Corners[4];
+	float CornerU[4] = {MinU, MaxU, MinU, MaxU};
+	float CornerV[4] = {MinV, MinV, MaxV, MaxV};
+
+	for (int32 i = 0; i < 4; i++)
+	{
+		FVector Local;
+		Local[Axis] = Plane;
+		Local[U] = CornerU[i];
+		Local[V] = CornerV[i];
+
+		Corners[i] = Origin + FVector(Local.X, Local.Y, Local.Z + 1) * BlockSize;
+	}
+
+	//Corners 0, 1, 2 turn from U to V, which faces along the axis. Render faces may turn the other way
+	auto TableCorner = [Face](int32 Corner)
+	{
+		return FVector(VoxelFace::Corners[Face][Corner][0], VoxelFace::Corners[Face][Corner][1], VoxelFace::Corners[Face][Corner][2]);
+	};
+	FVector Normal = FVector(VoxelFace::Offsets[Face][0], VoxelFace::Offsets[Face][1], VoxelFace::Offsets[Face][2]);
+	FVector TableCross = FVector::CrossProduct(TableCorner(1) - TableCorner(0), TableCorner(2) - TableCorner(0));
+	bool bIsSameWinding = (FVector::DotProduct(TableCross, Normal) > 0) == (VoxelFace::Offsets[Face][Axis] > 0);
+
+	int32 FirstVertex = Vertices.Num();
+	Vertices.Append(Corners, 4);
+
+	const int32 ReversedCorners[6] = {0, 2, 1, 2, 3, 1};
+	const int32* TriangleCorners = bIsSameWinding ? VoxelFace::TriangleCorners : ReversedCorners;
+
+	for (int32 i = 0; i < 6; i++)
+	{
+		Triangles.Add(FirstVertex + TriangleCorners[i]);
+	}
+}
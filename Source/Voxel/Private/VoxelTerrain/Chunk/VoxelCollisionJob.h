@@ -0,0 +1,57 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "../../Structs/Block.h"
+#include "../../Structs/VoxelBitset.h"
+
+struct FVoxelGenerationSettings;
+
+/**
+ * Collision build of one chunk.
+ * 
+ * Holds a copy of everything the build reads and the triangles it produces, so it can run on
+   a background thread while the chunk keeps changing, and is handed back on the game thread.
+ */
+struct FVoxelCollisionJob
+{
+	public:
+		TSharedPtr<const FVoxelGenerationSettings> Settings;
+		TArray<FBlock> Blocks;
+		FVoxelBitset BorderSolid;
+		FVector Origin;
+		int32 BlockSize = 0;
+		int32 Width = 0;
+		int32 Height = 0;
+		int32 MinSolidZ = 0;
+		int32 MaxSolidZ = -1;
+
+		//Collision generation of the chunk when the job was started, see AChunk::CollisionGeneration
+		uint32 Generation = 0;
+
+		//Collision triangles in world space
+		TArray<FVector> Vertices;
+		TArray<int32> Triangles;
+
+		/**
+		 * Merges the exposed faces of collidable blocks into as few rectangles as possible.
+		 */
+		void Build();
+
+	private:
+		/**
+		 * Whether a face of a collidable block borders something that can be walked into.
+		 * Below the chunk never can, beside it only the border data from the generator is known.
+		 */
+		bool IsCollisionFace(const FIntVector& Local, int32 Face) const;
+
+		/**
+		 * Adds two triangles covering a merged rectangle of faces, wound like the faces of the mesh.
+		 * Plane and rectangle bounds are in block units, with block centers on whole numbers.
+		 */
+		void AddQuad(int32 Face, float Plane, float MinU, float MinV, float MaxU, float MaxV);
+
+		int32 GetBlockIndex(int32 X, int32 Y, int32 Z) const
+		{
+			return Z + Height * (X + Width * Y);
+		}
+};
@@ -0,0 +1,103 @@
+#include "VoxelTerrain/Generation/VoxelDensityLattice.h"
+#include "VoxelNoiseTileCache.h"
+#include "../../FastNoiseLite.h"
+
+namespace
+{
+	//Points per tile side along X and Y, tiles hold all points along Z
+	constexpr int32 TileSize = 8;
+}
+
+void FVoxelDensityLattice::Sample(const FastNoiseLite& Noise, uint32 NoiseHash, int32 InCellSize, const FIntPoint& MinColumn, const FIntPoint& MaxColumn, int32 Height)
+{
+	CellSize = FMath::Max(InCellSize, 1);
+
+	//A block needs the points on both sides of its cell
+	FirstPoint = GetCell(MinColumn.X, MinColumn.Y, 0);
+	FIntVector LastPoint = GetCell(MaxColumn.X, MaxColumn.Y, Height - 1) + FIntVector(1, 1, 1);
+	NumPoints = LastPoint - FirstPoint + FIntVector(1, 1, 1);
+
+	Values.SetNumUninitialized(NumPoints.X * NumPoints.Y * NumPoints.Z);
+
+	//Tiles hold whole columns of points, so the cell size and height are part of what they are
+	uint32 TileHash = HashCombineFast(NoiseHash, HashCombineFast(GetTypeHash(CellSize), GetTypeHash(NumPoints.Z)));
+	int32 TileStrideZ = TileSize * TileSize;
+
+	for (int32 TileY = FloorDiv(FirstPoint.Y, TileSize); TileY <= FloorDiv(LastPoint.Y, TileSize); TileY++)
+	{
+		for (int32 TileX = FloorDiv(FirstPoint.X, TileSize); TileX <= FloorDiv(LastPoint.X, TileSize); TileX++)
+		{
+			FIntPoint TileOrigin = FIntPoint(TileX, TileY) * TileSize;
+
+			TSharedRef<const FVoxelNoiseTileCache::FTile> Tile = FVoxelNoiseTileCache::Get().FindOrCompute(TileHash, FIntVector(TileX, TileY, 0), [&](FVoxelNoiseTileCache::FTile& OutTile)
+			{
+				OutTile.SetNumUninitialized(TileStrideZ * NumPoints.Z);
+				float* Value = OutTile.GetData();
+
+				for (int32 PointZ = 0; PointZ < NumPoints.Z; PointZ++)
+				{
+					for (int32 PointY = TileOrigin.Y; PointY < TileOrigin.Y + TileSize; PointY++)
+					{
+						for (int32 PointX = TileOrigin.X; PointX < TileOrigin.X + TileSize; PointX++)
+						{
+							*Value++ = Noise.GetNoise(
+								static_cast<float>(PointX * CellSize),
+								static_cast<float>(PointY * CellSize),
+								static_cast<float>(PointZ * CellSize)
+							);
+						}
+					}
+				}
+			});
+
+			//Copy the part of the tile this lattice covers
+			int32 MinX = FMath::Max(FirstPoint.X, TileOrigin.X);
+			int32 MaxX = FMath::Min(LastPoint.X, TileOrigin.X + TileSize - 1);
+			int32 MinY = FMath::Max(FirstPoint.Y, TileOrigin.Y);
+			int32 MaxY = FMath::Min(LastPoint.Y, TileOrigin.Y + TileSize - 1);
+
+			for (int32 PointZ = 0; PointZ < NumPoints.Z; PointZ++)
+			{
+				for (int32 PointY = MinY; PointY <= MaxY; PointY++)
+				{
+					const float* Source = Tile->GetData() + (MinX - TileOrigin.X) + TileSize * (PointY - TileOrigin.Y) + TileStrideZ * PointZ;
+					FMemory::Memcpy(&Values[GetPointIndex(MinX, PointY, PointZ)], Source, (MaxX - MinX + 1) * sizeof(float));
+				}
+			}
+		}
+	}
+}
+
+float FVoxelDensityLattice::GetValue(int32 X, int32 Y, int32 Z) const
+{
+	FIntVector Cell = GetCell(X, Y, Z);
+
+	float Corners[8];
+	GetCorners(Cell, Corners);
+
+	float InvCellSize = 1.0f / CellSize;
+	float FX = (X - Cell.X * CellSize) * InvCellSize;
+	float FY = (Y - Cell.Y * CellSize) * InvCellSize;
+	float FZ = (Z - Cell.Z * CellSize) * InvCellSize;
+
+	float Bottom = FMath::Lerp(FMath::Lerp(Corners[0], Corners[1], FX), FMath::Lerp(Corners[2], Corners[3], FX), FY);
+	float Top = FMath::Lerp(FMath::Lerp(Corners[4], Corners[5], FX), FMath::Lerp(Corners[6], Corners[7], FX), FY);
+
+	return FMath::Lerp(Bottom, Top, FZ);
+}
+
+void FVoxelDensityLattice::GetCorners(const FIntVector& Cell, float OutCorners[8]) const
+{
+	int32 Base = GetPointIndex(Cell.X, Cell.Y, Cell.Z);
+	int32 StrideY = NumPoints.X;
+	int32 StrideZ = NumPoints.X * NumPoints.Y;
+
+	OutCorners[0] = Values[Base];
+	OutCorners[1] = Values[Base + 1];
+	OutCorners[2] = Values[Base + StrideY];
+	OutCorners[3] = Values[Base + StrideY + 1];
+	OutCorners[4] = Values[Base + StrideZ];
+	OutCorners[5] = Values[Base + StrideZ + 1];
+	OutCorners[6] = Values[Base + StrideZ + StrideY];
+	OutCorners[7] = Values[Base + StrideZ + StrideY + 1];
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FastNoiseLite;
+
+/**
+ * 3D noise sampled every CellSize blocks and trilinearly interpolated in between.
+ * 
+ * The lattice is aligned to world block coordinates, so every chunk sees the same
+   values on a shared border and nothing depends on which chunk sampled them.
+   Points are sampled through FVoxelNoiseTileCache in tiles of whole columns, so
+   neighbouring chunks only sample their shared points once.
+ */
+class FVoxelDensityLattice
+{
+public:
+	/**
+	 * Samples Noise on every lattice point needed to interpolate the blocks of the columns
+	   from MinColumn to MaxColumn, inclusive, in world block coordinates, from Z 0 to Height - 1.
+	 * NoiseHash identifies the noise and its seed in the tile cache.
+	 */
+	void Sample(const FastNoiseLite& Noise, uint32 NoiseHash, int32 InCellSize, const FIntPoint& MinColumn, const FIntPoint& MaxColumn, int32 Height);
+
+	/**
+	 * Interpolated value at a world block inside the sampled range.
+	 */
+	float GetValue(int32 X, int32 Y, int32 Z) const;
+
+	/**
+	 * Values at the 8 corners of a cell, X changing fastest, then Y, then Z.
+	 * Interpolated values inside the cell never leave the range of its corners.
+	 */
+	void GetCorners(const FIntVector& Cell, float OutCorners[8]) const;
+
+	/**
+	 * Cell holding a world block.
+	 */
+	FIntVector GetCell(int32 X, int32 Y, int32 Z) const
+	{
+		return FIntVector(FloorDiv(X), FloorDiv(Y), FloorDiv(Z));
+	}
+
+	int32 GetCellSize() const { return CellSize; }
+
+private:
+	int32 FloorDiv(int32 Value) const
+	{
+		return FloorDiv(Value, CellSize);
+	}
+
+	static int32 FloorDiv(int32 Value, int32 Divisor)
+	{
+		return Value >= 0 ? Value / Divisor : (Value - Divisor + 1) / Divisor;
+	}
+
+	int32 GetPointIndex(int32 PointX, int32 PointY, int32 PointZ) const
+	{
+		return (PointX - FirstPoint.X) + NumPoints.X * ((PointY - FirstPoint.Y) + NumPoints.Y * (PointZ - FirstPoint.Z));
+	}
+
+	int32 CellSize = 1;
+
+	//Lattice coordinate of the first sampled point and number of points along each axis
+	FIntVector FirstPoint = FIntVector::ZeroValue;
+	FIntVector NumPoints = FIntVector::ZeroValue;
+
+	TArray<float> Values;
+};
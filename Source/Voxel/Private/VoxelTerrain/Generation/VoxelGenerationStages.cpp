@@ -0,0 +1,576 @@
+#include "VoxelTerrain/Generation/VoxelGenerationStages.h"
+#include "Voxel.h"
+#include "VoxelGenerator.h"
+#include "../../FastNoiseLite.h"
+#include "../../Enums/BlockType.h"
+#include "../../Structs/Block.h"
+#include "../../Structs/VoxelChunkBuffer.h"
+
+DECLARE_CYCLE_STAT(TEXT("Generation Base Density"), STAT_VoxelStageBaseDensity, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("Generation Biome"), STAT_VoxelStageBiome, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("Generation Surface"), STAT_VoxelStageSurface, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("Generation Overhangs"), STAT_VoxelStageOverhangs, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("Generation Caves"), STAT_VoxelStageCaves, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("Generation Decoration"), STAT_VoxelStageDecoration, STATGROUP_Voxel);
+
+namespace
+{
+	//Added to the world seed so the noises of different stages are not correlated
+	constexpr int32 BiomeSeedOffset = 1;
+	constexpr int32 CaveSeedOffset = 2;
+	constexpr int32 DecorationSeedOffset = 3;
+	constexpr int32 OverhangSeedOffset = 4;
+
+	//How ForEachCellBlock handles one lattice cell
+	enum class ECellAction : uint8
+	{
+		//Nothing in the cell changes
+		Skip,
+		//Every block in the cell gets the same result, given by the lowest corner value
+		UseMin,
+		//Every block in the cell gets the same result, given by the highest corner value
+		UseMax,
+		Interpolate
+	};
+
+	/**
+	 * Visits the blocks of the chunk from Z 0 to MaxZ cell by cell.
+	 * Classify(Min, Max, LocalMin, LocalMax) gets the range of the cell corners and the
+	   local blocks covered by the cell, Visit(Column, Z, Value) is called for every block
+	   unless the cell is skipped. Interpolation runs along Z, the way blocks are stored.
+	 */
+	template <typename ClassifyType, typename VisitType>
+	void ForEachCellBlock(const FVoxelGenerationContext& Context, int32 MaxZ, ClassifyType&& Classify, VisitType&& Visit)
+	{
+		const FVoxelDensityLattice& Lattice = Context.Lattice;
+		int32 CellSize = Lattice.GetCellSize();
+		int32 Width = Context.Width;
+		bool bSkipUniformCells = Context.Params->bSkipUniformCells;
+		float InvCellSize = 1.0f / CellSize;
+
+		FIntVector FirstCell = Lattice.GetCell(Context.FirstColumn.X, Context.FirstColumn.Y, 0);
+		FIntVector LastCell = Lattice.GetCell(Context.FirstColumn.X + Width - 1, Context.FirstColumn.Y + Width - 1, MaxZ);
+
+		for (int32 CellZ = FirstCell.Z; CellZ <= LastCell.Z; CellZ++)
+		{
+			for (int32 CellY = FirstCell.Y; CellY <= LastCell.Y; CellY++)
+			{
+				for (int32 CellX = FirstCell.X; CellX <= LastCell.X; CellX++)
+				{
+					FIntVector Cell = FIntVector(CellX, CellY, CellZ);
+					FIntVector CellOrigin = FIntVector(CellX * CellSize - Context.FirstColumn.X, CellY * CellSize - Context.FirstColumn.Y, CellZ * CellSize);
+
+					FIntVector LocalMin = FIntVector(FMath::Max(CellOrigin.X, 0), FMath::Max(CellOrigin.Y, 0), FMath::Max(CellOrigin.Z, 0));
+					FIntVector LocalMax = FIntVector(
+						FMath::Min(CellOrigin.X + CellSize - 1, Width - 1),
+						FMath::Min(CellOrigin.Y + CellSize - 1, Width - 1),
+						FMath::Min(CellOrigin.Z + CellSize - 1, MaxZ)
+					);
+
+					float Corners[8];
+					Lattice.GetCorners(Cell, Corners);
+
+					float MinValue = Corners[0];
+					float MaxValue = Corners[0];
+					for (int32 Corner = 1; Corner < 8; Corner++)
+					{
+						MinValue = FMath::Min(MinValue, Corners[Corner]);
+						MaxValue = FMath::Max(MaxValue, Corners[Corner]);
+					}
+
+					ECellAction Action = Classify(MinValue, MaxValue, LocalMin, LocalMax);
+					if (Action == ECellAction::Skip) continue;
+
+					if (!bSkipUniformCells && Action != ECellAction::Interpolate)
+						Action = ECellAction::Interpolate;
+
+					for (int32 Y = LocalMin.Y; Y <= LocalMax.Y; Y++)
+					{
+						for (int32 X = LocalMin.X; X <= LocalMax.X; X++)
+						{
+							int32 Column = X + Width * Y;
+
+							if (Action != ECellAction::Interpolate)
+							{
+								float Value = Action == ECellAction::UseMin ? MinValue : MaxValue;
+								for (int32 Z = LocalMin.Z; Z <= LocalMax.Z; Z++)
+								{
+									Visit(Column, Z, Value);
+								}
+								continue;
+							}
+
+							float FX = (X - CellOrigin.X) * InvCellSize;
+							float FY = (Y - CellOrigin.Y) * InvCellSize;
+							float Bottom = FMath::Lerp(FMath::Lerp(Corners[0], Corners[1], FX), FMath::Lerp(Corners[2], Corners[3], FX), FY);
+							float Top = FMath::Lerp(FMath::Lerp(Corners[4], Corners[5], FX), FMath::Lerp(Corners[6], Corners[7], FX), FY);
+							float Step = (Top - Bottom) * InvCellSize;
+
+							for (int32 Z = LocalMin.Z; Z <= LocalMax.Z; Z++)
+							{
+								Visit(Column, Z, Bottom + Step * (Z - CellOrigin.Z));
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	/**
+	 * Samples a 3D noise on the lattice for the chunk and the blocks right around it.
+	 */
+	void SampleLattice(FVoxelGenerationContext& Context, int32 SeedOffset, const FVoxelNoiseParams& NoiseParams)
+	{
+		FastNoiseLite Noise;
+		FVoxelGenerator::ConfigureNoise(Noise, Context.Seed + SeedOffset, NoiseParams);
+
+		Context.Lattice.Sample(
+			Noise,
+			FVoxelGenerator::HashNoise(Context.Seed + SeedOffset, NoiseParams),
+			Context.Params->DensityCellSize,
+			Context.FirstColumn - FIntPoint(1, 1),
+			Context.FirstColumn + FIntPoint(Context.Width, Context.Width),
+			Context.Height
+		);
+	}
+
+	/**
+	 * Recomputes the bounds and surface of the columns marked in ChangedColumns.
+	 */
+	void UpdateChangedColumns(FVoxelGenerationContext& Context)
+	{
+		FVoxelChunkBuffer& Buffer = *Context.Buffer;
+		int32 Height = Context.Height;
+
+		for (int32 Column = 0; Column < Context.ChangedColumns.Num(); Column++)
+		{
+			if (!Context.ChangedColumns[Column]) continue;
+
+			const FBlock* ColumnBlocks = Buffer.Blocks.GetData() + Height * Column;
+			int32 MinZ = Height;
+			int32 MaxZ = -1;
+
+			for (int32 Z = 0; Z < Height; Z++)
+			{
+				if (ColumnBlocks[Z].Type == EBlockType::Air) continue;
+
+				MinZ = FMath::Min(MinZ, Z);
+				MaxZ = Z;
+			}
+
+			Buffer.ColumnMinZ[Column] = MinZ;
+			Buffer.ColumnMaxZ[Column] = MaxZ;
+			Context.SurfaceZ[Column] = MaxZ;
+		}
+	}
+
+	/**
+	 * Recomputes the highest solid Z of the columns right outside the chunk from the border bits.
+	 */
+	void UpdateBorderSurface(FVoxelGenerationContext& Context)
+	{
+		int32 Width = Context.Width;
+		int32 Height = Context.Height;
+
+		for (int32 Side = 0; Side < FVoxelChunkBuffer::NumBorderSides; Side++)
+		{
+			for (int32 Along = 0; Along < Width; Along++)
+			{
+				int32 TopZ = Height - 1;
+				while (TopZ >= 0 && !Context.Buffer->BorderSolid.Contains(FVoxelChunkBuffer::GetBorderIndex(Side, Along, TopZ, Width, Height)))
+				{
+					TopZ--;
+				}
+
+				Context.BorderSurfaceZ[Side * Width + Along] = TopZ;
+			}
+		}
+	}
+}
+
+void VoxelGenerationStages::BaseDensity(FVoxelGenerationContext& Context)
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelStageBaseDensity);
+
+	const FVoxelGeneratorParams& Params = *Context.Params;
+	FVoxelChunkBuffer& Buffer = *Context.Buffer;
+	int32 Width = Context.Width;
+	int32 Height = Context.Height;
+	int32 ColumnCount = Width * Width;
+
+	FastNoiseLite HeightNoise;
+	FVoxelGenerator::ConfigureNoise(HeightNoise, Context.Seed, Params.HeightNoise);
+
+	float WorldToNoise = Params.BlockSize / Params.NoiseScale;
+
+	//The warp is evaluated on a coarse grid reaching one column past the chunk and interpolated per sample
+	bool bDomainWarp = Params.bDomainWarp;
+	if (bDomainWarp)
+	{
+		FastNoiseLite WarpNoise;
+		FVoxelGenerator::ConfigureWarpNoise(WarpNoise, Context.Seed, Params);
+
+		Context.WarpField.Build(
+			WarpNoise,
+			FVoxelGenerator::HashWarpNoise(Context.Seed, Params),
+			WorldToNoise,
+			Params.WarpCellSize,
+			Context.FirstColumn - FIntPoint(1, 1),
+			Context.FirstColumn + FIntPoint(Width, Width)
+		);
+	}
+
+	auto SampleHeight = [&Context, &HeightNoise, WorldToNoise, bDomainWarp](const FIntPoint& WorldColumn)
+	{
+		FVector2f Offset = bDomainWarp ? Context.WarpField.GetOffset(WorldColumn.X, WorldColumn.Y) : FVector2f::ZeroVector;
+		return HeightNoise.GetNoise(WorldColumn.X * WorldToNoise + Offset.X, WorldColumn.Y * WorldToNoise + Offset.Y);
+	};
+
+	//Pass 1: sample the noise of all columns, the ones right outside the chunk after the chunk's own
+	int32 BorderCount = FVoxelChunkBuffer::NumBorderSides * Width;
+	Context.NoiseValues.SetNumUninitialized(ColumnCount + BorderCount);
+	float* NoiseValues = Context.NoiseValues.GetData();
+
+	for (int32 Y = 0; Y < Width; Y++)
+	{
+		for (int32 X = 0; X < Width; X++)
+		{
+			NoiseValues[X + Width * Y] = SampleHeight(Context.FirstColumn + FIntPoint(X, Y));
+		}
+	}
+
+	for (int32 Side = 0; Side < FVoxelChunkBuffer::NumBorderSides; Side++)
+	{
+		for (int32 Along = 0; Along < Width; Along++)
+		{
+			FIntPoint BorderColumn = Context.FirstColumn + FVoxelChunkBuffer::GetBorderColumn(Side, Along, Width);
+			NoiseValues[ColumnCount + Side * Width + Along] = SampleHeight(BorderColumn);
+		}
+	}
+
+	//Pass 2: turn noise into the highest solid Z, same as FVoxelGenerator::GetColumnHeight
+	Context.SurfaceZ.SetNumUninitialized(ColumnCount);
+	Context.BorderSurfaceZ.SetNumUninitialized(BorderCount);
+
+	float MinHeight = Params.MinTerrainHeight;
+	float HeightRange = Params.MaxTerrainHeight - Params.MinTerrainHeight;
+
+	auto ToSurfaceZ = [&Params, MinHeight, HeightRange, Height](float NoiseValue)
+	{
+		int32 BlockHeight = static_cast<int32>((NoiseValue + 1.0f) * 0.5f * HeightRange + MinHeight);
+		BlockHeight = FMath::Clamp(BlockHeight, Params.MinTerrainHeight, Params.MaxTerrainHeight);
+
+		//Block at level Z + 1 is solid while it is below the column height
+		return static_cast<int16>(FMath::Min(BlockHeight - 2, Height - 1));
+	};
+
+	for (int32 Column = 0; Column < ColumnCount; Column++)
+	{
+		Context.SurfaceZ[Column] = ToSurfaceZ(NoiseValues[Column]);
+	}
+
+	for (int32 Border = 0; Border < BorderCount; Border++)
+	{
+		Context.BorderSurfaceZ[Border] = ToSurfaceZ(NoiseValues[ColumnCount + Border]);
+	}
+
+	const int16* SurfaceZ = Context.SurfaceZ.GetData();
+
+	//Pass 3: fill the columns, everything else is air
+	Buffer.Blocks.Init(FBlock(EBlockType::Air, 0, true), ColumnCount * Height);
+	Buffer.ColumnMinZ.Init(Height, ColumnCount);
+	Buffer.ColumnMaxZ.Init(-1, ColumnCount);
+
+	FBlock Fill = FBlock(Params.FillType, 0, true);
+	FBlock* Blocks = Buffer.Blocks.GetData();
+
+	for (int32 Column = 0; Column < ColumnCount; Column++)
+	{
+		int32 TopZ = SurfaceZ[Column];
+		if (TopZ < 0) continue;
+
+		FBlock* ColumnBlocks = Blocks + Height * Column;
+		for (int32 Z = 0; Z <= TopZ; Z++)
+		{
+			ColumnBlocks[Z] = Fill;
+		}
+
+		Buffer.ColumnMinZ[Column] = 0;
+		Buffer.ColumnMaxZ[Column] = TopZ;
+	}
+
+	Buffer.BorderSolid.Init(BorderCount * Height);
+
+	for (int32 Border = 0; Border < BorderCount; Border++)
+	{
+		for (int32 Z = 0; Z <= Context.BorderSurfaceZ[Border]; Z++)
+		{
+			Buffer.BorderSolid.Set(Border * Height + Z);
+		}
+	}
+}
+
+void VoxelGenerationStages::Biome(FVoxelGenerationContext& Context)
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelStageBiome);
+
+	const FVoxelGeneratorParams& Params = *Context.Params;
+	int32 Width = Context.Width;
+	int32 ColumnCount = Width * Width;
+
+	Context.Biomes.Init(0, ColumnCount);
+	if (Params.Biomes.Num() <= 1) return;
+
+	FastNoiseLite BiomeNoise;
+	FVoxelGenerator::ConfigureNoise(BiomeNoise, Context.Seed + BiomeSeedOffset, Params.BiomeNoise);
+
+	//Biome noise is sampled per block, its frequency is set for that
+	Context.NoiseValues.SetNumUninitialized(ColumnCount);
+	float* NoiseValues = Context.NoiseValues.GetData();
+
+	for (int32 Y = 0; Y < Width; Y++)
+	{
+		for (int32 X = 0; X < Width; X++)
+		{
+			NoiseValues[X + Width * Y] = BiomeNoise.GetNoise(
+				static_cast<float>(Context.FirstColumn.X + X),
+				static_cast<float>(Context.FirstColumn.Y + Y)
+			);
+		}
+	}
+
+	//Biomes are few, so one compare pass per biome from the last to the first
+	uint8* Biomes = Context.Biomes.GetData();
+	int32 LastBiome = FMath::Min(Params.Biomes.Num(), 256) - 1;
+
+	for (int32 Column = 0; Column < ColumnCount; Column++)
+	{
+		Biomes[Column] = static_cast<uint8>(LastBiome);
+	}
+
+	for (int32 Index = LastBiome - 1; Index >= 0; Index--)
+	{
+		float MaxNoise = Params.Biomes[Index].MaxBiomeNoise;
+		for (int32 Column = 0; Column < ColumnCount; Column++)
+		{
+			Biomes[Column] = NoiseValues[Column] <= MaxNoise ? static_cast<uint8>(Index) : Biomes[Column];
+		}
+	}
+}
+
+void VoxelGenerationStages::Surface(FVoxelGenerationContext& Context)
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelStageSurface);
+
+	const FVoxelGeneratorParams& Params = *Context.Params;
+	if (Params.Biomes.IsEmpty() || Params.SurfaceDepth <= 0) return;
+
+	int32 Width = Context.Width;
+	int32 Height = Context.Height;
+	int32 ColumnCount = Width * Width;
+	bool bHasBiomes = Context.Biomes.Num() == ColumnCount;
+
+	FBlock* Blocks = Context.Buffer->Blocks.GetData();
+
+	for (int32 Column = 0; Column < ColumnCount; Column++)
+	{
+		int32 TopZ = Context.SurfaceZ[Column];
+		if (TopZ < 0) continue;
+
+		int32 BiomeIndex = bHasBiomes ? Context.Biomes[Column] : 0;
+		EBlockType SurfaceType = Params.Biomes[BiomeIndex].SurfaceType;
+
+		FBlock* ColumnBlocks = Blocks + Height * Column;
+		for (int32 Z = FMath::Max(0, TopZ - Params.SurfaceDepth + 1); Z <= TopZ; Z++)
+		{
+			//Caves may already have been carved when the stages are reordered
+			ColumnBlocks[Z].Type = ColumnBlocks[Z].Type == EBlockType::Air ? EBlockType::Air : SurfaceType;
+		}
+	}
+}
+
+void VoxelGenerationStages::Overhangs(FVoxelGenerationContext& Context)
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelStageOverhangs);
+
+	const FVoxelGeneratorParams& Params = *Context.Params;
+	float Strength = Params.OverhangStrength;
+	if (Strength <= 0.0f) return;
+
+	FVoxelChunkBuffer& Buffer = *Context.Buffer;
+	int32 Width = Context.Width;
+	int32 Height = Context.Height;
+
+	SampleLattice(Context, OverhangSeedOffset, Params.OverhangNoise);
+
+	Context.ChangedColumns.Init(false, Width * Width);
+
+	FBlock Fill = FBlock(Params.FillType, 0, true);
+	FBlock* Blocks = Buffer.Blocks.GetData();
+	const int16* SurfaceZ = Context.SurfaceZ.GetData();
+	bool* ChangedColumns = Context.ChangedColumns.GetData();
+
+	//A block is solid while (SurfaceZ - Z) + Strength * Noise >= 0, so a noise of 0 keeps the heightmap
+	auto Classify = [&](float MinValue, float MaxValue, const FIntVector& LocalMin, const FIntVector& LocalMax)
+	{
+		int32 MinSurfaceZ = Height;
+		int32 MaxSurfaceZ = -1;
+
+		for (int32 Y = LocalMin.Y; Y <= LocalMax.Y; Y++)
+		{
+			for (int32 X = LocalMin.X; X <= LocalMax.X; X++)
+			{
+				MinSurfaceZ = FMath::Min<int32>(MinSurfaceZ, SurfaceZ[X + Width * Y]);
+				MaxSurfaceZ = FMath::Max<int32>(MaxSurfaceZ, SurfaceZ[X + Width * Y]);
+			}
+		}
+
+		if (MinSurfaceZ - LocalMax.Z + Strength * MinValue >= 0.0f)
+			return LocalMax.Z <= MinSurfaceZ ? ECellAction::Skip : ECellAction::UseMin;
+
+		if (MaxSurfaceZ - LocalMin.Z + Strength * MaxValue < 0.0f)
+			return LocalMin.Z > MaxSurfaceZ ? ECellAction::Skip : ECellAction::UseMax;
+
+		return ECellAction::Interpolate;
+	};
+
+	ForEachCellBlock(Context, Height - 1, Classify, [&](int32 Column, int32 Z, float Value)
+	{
+		bool bIsSolid = SurfaceZ[Column] - Z + Strength * Value >= 0.0f;
+		FBlock& Block = Blocks[Z + Height * Column];
+
+		//Only solidity changes, so blocks painted by earlier stages keep their type
+		if (bIsSolid == (Block.Type != EBlockType::Air)) return;
+
+		Block = bIsSolid ? Fill : FBlock(EBlockType::Air, 0, true);
+		ChangedColumns[Column] = true;
+	});
+
+	for (int32 Side = 0; Side < FVoxelChunkBuffer::NumBorderSides; Side++)
+	{
+		for (int32 Along = 0; Along < Width; Along++)
+		{
+			FIntPoint BorderColumn = Context.FirstColumn + FVoxelChunkBuffer::GetBorderColumn(Side, Along, Width);
+			int32 BorderSurfaceZ = Context.BorderSurfaceZ[Side * Width + Along];
+
+			for (int32 Z = 0; Z < Height; Z++)
+			{
+				float Value = Context.Lattice.GetValue(BorderColumn.X, BorderColumn.Y, Z);
+				int32 BorderIndex = FVoxelChunkBuffer::GetBorderIndex(Side, Along, Z, Width, Height);
+
+				if (BorderSurfaceZ - Z + Strength * Value >= 0.0f)
+					Buffer.BorderSolid.Set(BorderIndex);
+				else
+					Buffer.BorderSolid.Clear(BorderIndex);
+			}
+		}
+	}
+
+	UpdateChangedColumns(Context);
+	UpdateBorderSurface(Context);
+}
+
+void VoxelGenerationStages::Caves(FVoxelGenerationContext& Context)
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelStageCaves);
+
+	const FVoxelGeneratorParams& Params = *Context.Params;
+	FVoxelChunkBuffer& Buffer = *Context.Buffer;
+	int32 Width = Context.Width;
+	int32 Height = Context.Height;
+	float Threshold = Params.CaveThreshold;
+
+	//The bottom layer is never carved, so caves never open into the void
+	int32 SurfaceMargin = FMath::Max(Params.CaveSurfaceMargin, 1);
+
+	int32 MaxCaveZ = -1;
+	for (int16 TopZ : Context.SurfaceZ)
+	{
+		MaxCaveZ = FMath::Max(MaxCaveZ, TopZ - SurfaceMargin);
+	}
+	for (int16 TopZ : Context.BorderSurfaceZ)
+	{
+		MaxCaveZ = FMath::Max(MaxCaveZ, TopZ - SurfaceMargin);
+	}
+
+	if (MaxCaveZ < 1) return;
+
+	SampleLattice(Context, CaveSeedOffset, Params.CaveNoise);
+
+	Context.ChangedColumns.Init(false, Width * Width);
+
+	FBlock* Blocks = Buffer.Blocks.GetData();
+	const int16* SurfaceZ = Context.SurfaceZ.GetData();
+	bool* ChangedColumns = Context.ChangedColumns.GetData();
+
+	auto Classify = [Threshold](float MinValue, float MaxValue, const FIntVector& LocalMin, const FIntVector& LocalMax)
+	{
+		if (MaxValue <= Threshold) return ECellAction::Skip;
+		if (MinValue > Threshold) return ECellAction::UseMin;
+
+		return ECellAction::Interpolate;
+	};
+
+	ForEachCellBlock(Context, MaxCaveZ, Classify, [&](int32 Column, int32 Z, float Value)
+	{
+		if (Value <= Threshold || Z < 1 || Z > SurfaceZ[Column] - SurfaceMargin) return;
+
+		FBlock& Block = Blocks[Z + Height * Column];
+		if (Block.Type == EBlockType::Air) return;
+
+		Block.Type = EBlockType::Air;
+		ChangedColumns[Column] = true;
+	});
+
+	for (int32 Side = 0; Side < FVoxelChunkBuffer::NumBorderSides; Side++)
+	{
+		for (int32 Along = 0; Along < Width; Along++)
+		{
+			FIntPoint BorderColumn = Context.FirstColumn + FVoxelChunkBuffer::GetBorderColumn(Side, Along, Width);
+			int32 BorderMaxCaveZ = Context.BorderSurfaceZ[Side * Width + Along] - SurfaceMargin;
+
+			for (int32 Z = 1; Z <= BorderMaxCaveZ; Z++)
+			{
+				if (Context.Lattice.GetValue(BorderColumn.X, BorderColumn.Y, Z) <= Threshold) continue;
+
+				Buffer.BorderSolid.Clear(FVoxelChunkBuffer::GetBorderIndex(Side, Along, Z, Width, Height));
+			}
+		}
+	}
+
+	UpdateChangedColumns(Context);
+}
+
+void VoxelGenerationStages::Decoration(FVoxelGenerationContext& Context)
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelStageDecoration);
+
+	const FVoxelGeneratorParams& Params = *Context.Params;
+	if (Params.Biomes.IsEmpty() || Params.DecorationVariants <= 0) return;
+
+	int32 Width = Context.Width;
+	int32 Height = Context.Height;
+	bool bHasBiomes = Context.Biomes.Num() == Width * Width;
+
+	FBlock* Blocks = Context.Buffer->Blocks.GetData();
+
+	for (int32 Y = 0; Y < Width; Y++)
+	{
+		for (int32 X = 0; X < Width; X++)
+		{
+			int32 Column = X + Width * Y;
+			int32 TopZ = Context.SurfaceZ[Column];
+			if (TopZ < 0) continue;
+
+			float Density = Params.Biomes[bHasBiomes ? Context.Biomes[Column] : 0].DecorationDensity;
+			if (Density <= 0.0f) continue;
+
+			uint32 Hash = FVoxelGenerator::HashPosition(Context.Seed + DecorationSeedOffset, Context.FirstColumn.X + X, Context.FirstColumn.Y + Y, TopZ);
+			if ((Hash & 0xFFFF) >= static_cast<uint32>(Density * 0xFFFF)) continue;
+
+			//Id 0 means no decoration
+			Blocks[TopZ + Height * Column].DecorationId = static_cast<uint16>(1 + (Hash >> 16) % Params.DecorationVariants);
+		}
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelDensityLattice.h"
+#include "VoxelWarpField.h"
+#include "../../Structs/VoxelGeneratorParams.h"
+
+struct FVoxelChunkBuffer;
+
+/**
+ * Working data of one chunk while it goes through the generation stages.
+ * 
+ * Per column arrays are indexed X + Width * Y, like the column bounds of the buffer.
+ */
+struct FVoxelGenerationContext
+{
+	public:
+		FIntPoint ChunkCoord;
+		FIntPoint FirstColumn;
+		int32 Seed;
+		int32 Width;
+		int32 Height;
+		const FVoxelGeneratorParams* Params;
+		FVoxelChunkBuffer* Buffer;
+
+		//Highest solid Z of every column, -1 for an empty column
+		TArray<int16> SurfaceZ;
+
+		//Highest solid Z of the columns right outside the chunk, see FVoxelChunkBuffer::GetBorderIndex
+		TArray<int16> BorderSurfaceZ;
+
+		//Index into Params->Biomes of every column
+		TArray<uint8> Biomes;
+
+		//Scratch for batched noise sampling
+		TArray<float> NoiseValues;
+		FVoxelDensityLattice Lattice;
+		FVoxelWarpField WarpField;
+		TArray<bool> ChangedColumns;
+};
+
+/**
+ * Generation stages. Each one makes a few tight passes over the whole chunk
+   instead of doing all the work block by block, so the passes stay simple
+   enough for the compiler to vectorize.
+ */
+namespace VoxelGenerationStages
+{
+	/**
+	 * Samples the height noise of every column and fills the columns up to it.
+	 * Has to run first, every other stage works on its output.
+	 */
+	void BaseDensity(FVoxelGenerationContext& Context);
+
+	/**
+	 * Picks the biome of every column from the biome noise.
+	 */
+	void Biome(FVoxelGenerationContext& Context);
+
+	/**
+	 * Paints the top blocks of every column with the surface type of its biome.
+	 */
+	void Surface(FVoxelGenerationContext& Context);
+
+	/**
+	 * Moves the surface up and down with 3D noise, making overhangs and floating islands.
+	 */
+	void Overhangs(FVoxelGenerationContext& Context);
+
+	/**
+	 * Carves caves out of the ground below the surface margin.
+	 */
+	void Caves(FVoxelGenerationContext& Context);
+
+	/**
+	 * Scatters decorations over the surface blocks, following the biome density.
+	 */
+	void Decoration(FVoxelGenerationContext& Context);
+}
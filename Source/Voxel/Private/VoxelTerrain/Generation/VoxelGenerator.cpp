@@ -0,0 +1,214 @@
+#include "VoxelTerrain/Generation/VoxelGenerator.h"
+#include "VoxelGenerationStages.h"
+#include "../../Structs/VoxelChunkBuffer.h"
+#include "VoxelWarpField.h"
+#include "HAL/PlatformTime.h"
+#include "Hash/CityHash.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	//Added to the world seed so the warp is not correlated with the height noise
+	constexpr int32 WarpSeedOffset = 5;
+
+	//Per worker so generating a chunk allocates nothing once warmed up
+	thread_local FVoxelGenerationContext GenerationContext;
+}
+
+FVoxelGenerationSettings::FVoxelGenerationSettings(int32 InSeed, const FVoxelGeneratorParams& InParams, const TSharedRef<const FVoxelBlockRegistry>& InBlocks)
+	: Blocks(InBlocks)
+{
+	Seed = InSeed;
+	Params = InParams;
+	FVoxelGenerator::ConfigureNoise(HeightNoise, Seed, Params.HeightNoise);
+	FVoxelGenerator::ConfigureWarpNoise(WarpNoise, Seed, Params);
+
+	bHasVolumetricStages = Params.Stages.Contains(EVoxelGenerationStage::Overhangs) || Params.Stages.Contains(EVoxelGenerationStage::Caves);
+}
+
+void FVoxelGenerator::Generate(const FIntPoint& ChunkCoord, int32 Seed, const FVoxelGeneratorParams& Params, FVoxelChunkBuffer& OutBuffer, FVoxelGenerationTimings* OutTimings)
+{
+	FVoxelGenerationContext& Context = GenerationContext;
+	Context.ChunkCoord = ChunkCoord;
+	Context.FirstColumn = ChunkCoord * Params.ChunkWidth;
+	Context.Seed = Seed;
+	Context.Width = Params.ChunkWidth;
+	Context.Height = Params.ChunkHeight;
+	Context.Params = &Params;
+	Context.Buffer = &OutBuffer;
+	Context.Biomes.Reset();
+
+	//Base density always runs first, every other stage works on top of it
+	RunStage(EVoxelGenerationStage::BaseDensity, Context, OutTimings);
+
+	for (EVoxelGenerationStage Stage : Params.Stages)
+	{
+		if (Stage == EVoxelGenerationStage::BaseDensity) continue;
+
+		RunStage(Stage, Context, OutTimings);
+	}
+
+	Context.Params = nullptr;
+	Context.Buffer = nullptr;
+}
+
+void FVoxelGenerator::ConfigureNoise(FastNoiseLite& Noise, int32 Seed, const FVoxelNoiseParams& Params)
+{
+	Noise.SetSeed(Seed);
+	Noise.SetFrequency(Params.Frequency);
+	Noise.SetNoiseType(static_cast<FastNoiseLite::NoiseType>(Params.NoiseType));
+	Noise.SetFractalType(static_cast<FastNoiseLite::FractalType>(Params.FractalType));
+	Noise.SetFractalOctaves(Params.Octaves);
+	Noise.SetFractalLacunarity(Params.Lacunarity);
+	Noise.SetFractalGain(Params.Gain);
+}
+
+void FVoxelGenerator::ConfigureWarpNoise(FastNoiseLite& Noise, int32 Seed, const FVoxelGeneratorParams& Params)
+{
+	Noise.SetSeed(Seed + WarpSeedOffset);
+	Noise.SetFrequency(Params.DomainWarpFrequency);
+	Noise.SetDomainWarpType(static_cast<FastNoiseLite::DomainWarpType>(Params.DomainWarpType));
+	Noise.SetDomainWarpAmp(Params.DomainWarpAmplitude);
+	Noise.SetFractalOctaves(Params.DomainWarpOctaves);
+
+	switch (Params.DomainWarpFractalType)
+	{
+		case EVoxelDomainWarpFractalType::Progressive:
+			Noise.SetFractalType(FastNoiseLite::FractalType_DomainWarpProgressive);
+			break;
+		case EVoxelDomainWarpFractalType::Independent:
+			Noise.SetFractalType(FastNoiseLite::FractalType_DomainWarpIndependent);
+			break;
+		default:
+			Noise.SetFractalType(FastNoiseLite::FractalType_None);
+			break;
+	}
+}
+
+uint64 FVoxelGenerator::HashWorld(int32 Seed, const FVoxelGeneratorParams& Params)
+{
+	//Every property of the params is hashed, so new parameters are covered without changes here
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+
+	uint32 GeneratorVersion = Version;
+	Writer << GeneratorVersion << Seed;
+	FVoxelGeneratorParams::StaticStruct()->SerializeBin(Writer, const_cast<FVoxelGeneratorParams*>(&Params));
+
+	return CityHash64(reinterpret_cast<const char*>(Bytes.GetData()), Bytes.Num());
+}
+
+uint32 FVoxelGenerator::HashNoise(int32 Seed, const FVoxelNoiseParams& NoiseParams)
+{
+	uint32 Hash = GetTypeHash(Seed);
+	Hash = HashCombineFast(Hash, GetTypeHash(NoiseParams.NoiseType));
+	Hash = HashCombineFast(Hash, GetTypeHash(NoiseParams.Frequency));
+	Hash = HashCombineFast(Hash, GetTypeHash(NoiseParams.FractalType));
+	Hash = HashCombineFast(Hash, GetTypeHash(NoiseParams.Octaves));
+	Hash = HashCombineFast(Hash, GetTypeHash(NoiseParams.Lacunarity));
+	Hash = HashCombineFast(Hash, GetTypeHash(NoiseParams.Gain));
+
+	return Hash;
+}
+
+uint32 FVoxelGenerator::HashWarpNoise(int32 Seed, const FVoxelGeneratorParams& Params)
+{
+	uint32 Hash = GetTypeHash(Seed + WarpSeedOffset);
+	Hash = HashCombineFast(Hash, GetTypeHash(Params.DomainWarpType));
+	Hash = HashCombineFast(Hash, GetTypeHash(Params.DomainWarpFractalType));
+	Hash = HashCombineFast(Hash, GetTypeHash(Params.DomainWarpAmplitude));
+	Hash = HashCombineFast(Hash, GetTypeHash(Params.DomainWarpFrequency));
+	Hash = HashCombineFast(Hash, GetTypeHash(Params.DomainWarpOctaves));
+
+	return Hash;
+}
+
+int32 FVoxelGenerator::GetColumnHeight(const FVoxelGenerationSettings& Settings, const FIntPoint& WorldColumn)
+{
+	const FVoxelGeneratorParams& Params = Settings.Params;
+	float WorldToNoise = Params.BlockSize / Params.NoiseScale;
+
+	FVector2f Offset = FVector2f::ZeroVector;
+	if (Params.bDomainWarp)
+	{
+		//Same interpolated offset a chunk holding this column gets
+		FVoxelWarpField WarpField;
+		WarpField.Build(Settings.WarpNoise, HashWarpNoise(Settings.Seed, Params), WorldToNoise, Params.WarpCellSize, WorldColumn, WorldColumn);
+		Offset = WarpField.GetOffset(WorldColumn.X, WorldColumn.Y);
+	}
+
+	float NoiseValue = Settings.HeightNoise.GetNoise(WorldColumn.X * WorldToNoise + Offset.X, WorldColumn.Y * WorldToNoise + Offset.Y);
+
+	return LimitNoise(NoiseValue, Params.MinTerrainHeight, Params.MaxTerrainHeight);
+}
+
+int32 FVoxelGenerator::LimitNoise(float NoiseValue, int32 MinHeight, int32 MaxHeight)
+{
+	float normalizedValue = (NoiseValue + 1.0f) / 2.0f;
+	int voxelHeight = static_cast<int>(normalizedValue * (MaxHeight - MinHeight) + MinHeight);
+
+	voxelHeight = FMath::Clamp(voxelHeight, MinHeight, MaxHeight);
+
+	return voxelHeight;
+}
+
+void FVoxelGenerator::RunStage(EVoxelGenerationStage Stage, FVoxelGenerationContext& Context, FVoxelGenerationTimings* OutTimings)
+{
+	uint64 StartCycles = FPlatformTime::Cycles64();
+
+	switch (Stage)
+	{
+		case EVoxelGenerationStage::BaseDensity:
+			VoxelGenerationStages::BaseDensity(Context);
+			break;
+		case EVoxelGenerationStage::Biome:
+			VoxelGenerationStages::Biome(Context);
+			break;
+		case EVoxelGenerationStage::Surface:
+			VoxelGenerationStages::Surface(Context);
+			break;
+		case EVoxelGenerationStage::Overhangs:
+			VoxelGenerationStages::Overhangs(Context);
+			break;
+		case EVoxelGenerationStage::Caves:
+			VoxelGenerationStages::Caves(Context);
+			break;
+		case EVoxelGenerationStage::Decoration:
+			VoxelGenerationStages::Decoration(Context);
+			break;
+		default:
+			return;
+	}
+
+	if (!OutTimings) return;
+
+	OutTimings->StageCycles[static_cast<int32>(Stage)] += FPlatformTime::Cycles64() - StartCycles;
+}
+
+uint32 FVoxelGenerator::HashPosition(int32 Seed, int32 X, int32 Y, int32 Z)
+{
+	uint32 Hash = HashCombineFast(GetTypeHash(FIntVector(X, Y, Z)), GetTypeHash(Seed));
+
+	//Mix the bits so neighbouring positions do not produce patterns
+	Hash ^= Hash >> 16;
+	Hash *= 0x7feb352d;
+	Hash ^= Hash >> 15;
+	Hash *= 0x846ca68b;
+	Hash ^= Hash >> 16;
+
+	return Hash;
+}
+
+const TCHAR* FVoxelGenerator::GetStageName(EVoxelGenerationStage Stage)
+{
+	switch (Stage)
+	{
+		case EVoxelGenerationStage::BaseDensity: return TEXT("Base Density");
+		case EVoxelGenerationStage::Biome: return TEXT("Biome");
+		case EVoxelGenerationStage::Surface: return TEXT("Surface");
+		case EVoxelGenerationStage::Overhangs: return TEXT("Overhangs");
+		case EVoxelGenerationStage::Caves: return TEXT("Caves");
+		case EVoxelGenerationStage::Decoration: return TEXT("Decoration");
+		default: return TEXT("Unknown");
+	}
+}
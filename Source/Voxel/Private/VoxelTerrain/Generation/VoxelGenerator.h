@@ -0,0 +1,116 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "../../FastNoiseLite.h"
+#include "../../Structs/VoxelGeneratorParams.h"
+
+struct FVoxelChunkBuffer;
+class FVoxelBlockRegistry;
+struct FVoxelGenerationContext;
+
+/**
+ * Seed and parameters of a world, together with the noise built from them.
+ * 
+ * Never changed after creation, so chunks and background jobs can share it.
+ */
+struct FVoxelGenerationSettings
+{
+	public:
+		FVoxelGenerationSettings(int32 InSeed, const FVoxelGeneratorParams& InParams, const TSharedRef<const FVoxelBlockRegistry>& InBlocks);
+
+		int32 Seed;
+		FVoxelGeneratorParams Params;
+
+		//Block types the world is built from
+		TSharedRef<const FVoxelBlockRegistry> Blocks;
+		FastNoiseLite HeightNoise;
+		FastNoiseLite WarpNoise;
+
+		//Whether stages change blocks in 3D, so the height noise alone does not tell which blocks are solid
+		bool bHasVolumetricStages;
+};
+
+/**
+ * Time spent in each generation stage, added up over every chunk generated with it.
+ */
+struct FVoxelGenerationTimings
+{
+	public:
+		uint64 StageCycles[static_cast<int32>(EVoxelGenerationStage::Count)] = {};
+};
+
+/**
+ * Terrain generator that needs no actor or UObject.
+ * 
+ * All functions are pure: the result only depends on the arguments, so they can be
+   called from any thread, in parallel, in game, tools and benchmarks alike.
+ */
+class FVoxelGenerator
+{
+public:
+	/**
+	 * Bump whenever a change to the generation code changes the blocks it produces,
+	   so chunks cached by older versions are not used anymore.
+	 */
+	static constexpr uint32 Version = 1;
+
+	/**
+	 * Fills OutBuffer with the blocks of the chunk at ChunkCoord, in chunk units,
+	   by running the stages listed in Params one after the other.
+	 * Memory already held by OutBuffer is reused. Stage times are added to OutTimings when given.
+	 */
+	static void Generate(const FIntPoint& ChunkCoord, int32 Seed, const FVoxelGeneratorParams& Params, FVoxelChunkBuffer& OutBuffer, FVoxelGenerationTimings* OutTimings = nullptr);
+
+	/**
+	 * Applies noise parameters and seed to a FastNoiseLite.
+	 */
+	static void ConfigureNoise(FastNoiseLite& Noise, int32 Seed, const FVoxelNoiseParams& Params);
+
+	/**
+	 * Applies the domain warp parameters and seed to a FastNoiseLite used for DomainWarp.
+	 */
+	static void ConfigureWarpNoise(FastNoiseLite& Noise, int32 Seed, const FVoxelGeneratorParams& Params);
+
+	/**
+	 * Hash of everything generated blocks depend on besides the chunk coordinate:
+	   the generator version, the seed and all parameters.
+	 */
+	static uint64 HashWorld(int32 Seed, const FVoxelGeneratorParams& Params);
+
+	/**
+	 * Hash of a noise and its seed, identifying its samples in FVoxelNoiseTileCache.
+	 */
+	static uint32 HashNoise(int32 Seed, const FVoxelNoiseParams& NoiseParams);
+
+	/**
+	 * Hash of the domain warp noise built by ConfigureWarpNoise, identifying its samples in FVoxelNoiseTileCache.
+	 */
+	static uint32 HashWarpNoise(int32 Seed, const FVoxelGeneratorParams& Params);
+
+	/**
+	 * Terrain height of a column, given in world block coordinates, before any 3D stage.
+	 * Blocks below this height are solid, Z being counted from 1 at the bottom of a chunk.
+	 */
+	static int32 GetColumnHeight(const FVoxelGenerationSettings& Settings, const FIntPoint& WorldColumn);
+
+	/**
+	 * Well mixed hash of a block position, always the same for the same seed and position.
+	 */
+	static uint32 HashPosition(int32 Seed, int32 X, int32 Y, int32 Z);
+
+	/**
+	 * Display name of a stage, for logs and reports.
+	 */
+	static const TCHAR* GetStageName(EVoxelGenerationStage Stage);
+
+private:
+	/**
+	 * Limits the noise value to within a specified height range.
+	 */
+	static int32 LimitNoise(float NoiseValue, int32 MinHeight, int32 MaxHeight);
+
+	/**
+	 * Runs one stage on the context and records its time.
+	 */
+	static void RunStage(EVoxelGenerationStage Stage, FVoxelGenerationContext& Context, FVoxelGenerationTimings* OutTimings);
+};
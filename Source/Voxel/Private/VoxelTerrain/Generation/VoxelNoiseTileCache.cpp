@@ -0,0 +1,133 @@
+#include "VoxelTerrain/Generation/VoxelNoiseTileCache.h"
+#include "Voxel.h"
+#include "Misc/ScopeLock.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Noise Cache Hits"), STAT_VoxelNoiseCacheHits, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Noise Cache Misses"), STAT_VoxelNoiseCacheMisses, STATGROUP_Voxel);
+DECLARE_MEMORY_STAT(TEXT("Noise Cache Memory"), STAT_VoxelNoiseCacheMemory, STATGROUP_Voxel);
+
+FVoxelNoiseTileCache::FVoxelNoiseTileCache()
+	: MaxBytes(64 * 1024 * 1024)
+	, Hits(0)
+	, Misses(0)
+	, Evictions(0)
+{
+}
+
+FVoxelNoiseTileCache& FVoxelNoiseTileCache::Get()
+{
+	static FVoxelNoiseTileCache Cache;
+	return Cache;
+}
+
+TSharedRef<const FVoxelNoiseTileCache::FTile> FVoxelNoiseTileCache::FindOrCompute(uint32 NoiseHash, const FIntVector& TileCoord, TFunctionRef<void(FTile&)> Compute)
+{
+	FKey Key = { NoiseHash, TileCoord };
+	FShard& Shard = GetShard(Key);
+
+	{
+		FScopeLock Lock(&Shard.Lock);
+
+		if (FEntry* Entry = Shard.Entries.Find(Key))
+		{
+			//Move to the head of the list without reallocating the node
+			Shard.Lru.RemoveNode(Entry->LruNode, false);
+			Shard.Lru.AddHead(Entry->LruNode);
+
+			Hits++;
+			INC_DWORD_STAT(STAT_VoxelNoiseCacheHits);
+			return Entry->Tile;
+		}
+	}
+
+	Misses++;
+	INC_DWORD_STAT(STAT_VoxelNoiseCacheMisses);
+
+	TSharedRef<FTile> NewTile = MakeShared<FTile>();
+	Compute(*NewTile);
+
+	FScopeLock Lock(&Shard.Lock);
+
+	//Another job may have stored the same tile while this one was computing
+	if (FEntry* Entry = Shard.Entries.Find(Key))
+		return Entry->Tile;
+
+	Shard.Lru.AddHead(Key);
+	Shard.Entries.Add(Key, FEntry{ NewTile, Shard.Lru.GetHead() });
+
+	int64 TileBytes = GetTileBytes(*NewTile);
+	Shard.Bytes += TileBytes;
+	INC_MEMORY_STAT_BY(STAT_VoxelNoiseCacheMemory, TileBytes);
+
+	EvictOverCap(Shard);
+
+	return NewTile;
+}
+
+void FVoxelNoiseTileCache::EvictOverCap(FShard& Shard)
+{
+	int64 ShardMaxBytes = MaxBytes / NumShards;
+
+	//The newest tile is never evicted, even when it alone is over the cap
+	while (Shard.Bytes > ShardMaxBytes && Shard.Lru.Num() > 1)
+	{
+		FLruList::TDoubleLinkedListNode* Oldest = Shard.Lru.GetTail();
+
+		FEntry Entry = Shard.Entries.FindAndRemoveChecked(Oldest->GetValue());
+		Shard.Lru.RemoveNode(Oldest);
+
+		int64 TileBytes = GetTileBytes(*Entry.Tile);
+		Shard.Bytes -= TileBytes;
+		DEC_MEMORY_STAT_BY(STAT_VoxelNoiseCacheMemory, TileBytes);
+
+		Evictions++;
+	}
+}
+
+void FVoxelNoiseTileCache::SetMaxBytes(int64 InMaxBytes)
+{
+	MaxBytes = FMath::Max<int64>(InMaxBytes, 0);
+
+	for (FShard& Shard : Shards)
+	{
+		FScopeLock Lock(&Shard.Lock);
+		EvictOverCap(Shard);
+	}
+}
+
+FVoxelNoiseTileCacheStats FVoxelNoiseTileCache::GetStats() const
+{
+	FVoxelNoiseTileCacheStats Stats;
+	Stats.Hits = Hits;
+	Stats.Misses = Misses;
+	Stats.Evictions = Evictions;
+
+	for (const FShard& Shard : Shards)
+	{
+		FScopeLock Lock(&Shard.Lock);
+		Stats.Bytes += Shard.Bytes;
+		Stats.Tiles += Shard.Entries.Num();
+	}
+
+	return Stats;
+}
+
+void FVoxelNoiseTileCache::ResetStats()
+{
+	Hits = 0;
+	Misses = 0;
+	Evictions = 0;
+}
+
+void FVoxelNoiseTileCache::Empty()
+{
+	for (FShard& Shard : Shards)
+	{
+		FScopeLock Lock(&Shard.Lock);
+
+		DEC_MEMORY_STAT_BY(STAT_VoxelNoiseCacheMemory, Shard.Bytes);
+		Shard.Entries.Empty();
+		Shard.Lru.Empty();
+		Shard.Bytes = 0;
+	}
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/List.h"
+#include "Templates/Function.h"
+#include <atomic>
+
+/**
+ * Counters of the noise tile cache since the last reset.
+ */
+struct FVoxelNoiseTileCacheStats
+{
+	public:
+		uint64 Hits = 0;
+		uint64 Misses = 0;
+		uint64 Evictions = 0;
+		int64 Bytes = 0;
+		int32 Tiles = 0;
+
+		double GetHitRate() const
+		{
+			uint64 Lookups = Hits + Misses;
+			return Lookups > 0 ? static_cast<double>(Hits) / Lookups : 0.0;
+		}
+};
+
+/**
+ * Process wide cache of noise samples, in world aligned tiles, shared by all generation jobs.
+ * 
+ * Neighbouring chunks sample the same noise around their shared border. With the tiles cached
+   the first job to need a tile computes it and every other job reuses it, whichever worker
+   it runs on. Tiles are spread over shards with their own lock and evicted least recently
+   used first once the memory cap is reached.
+ */
+class FVoxelNoiseTileCache
+{
+public:
+	using FTile = TArray<float>;
+
+	static FVoxelNoiseTileCache& Get();
+
+	/**
+	 * Returns the tile of the noise identified by NoiseHash at TileCoord, calling Compute
+	   to fill it on a miss. Compute runs without holding a lock, so two jobs missing the
+	   same tile at once may both compute it; the first one stored is kept.
+	 * The returned tile stays valid after being evicted.
+	 */
+	TSharedRef<const FTile> FindOrCompute(uint32 NoiseHash, const FIntVector& TileCoord, TFunctionRef<void(FTile&)> Compute);
+
+	/**
+	 * Sets the memory cap, evicting tiles right away when the cache is above it.
+	 */
+	void SetMaxBytes(int64 InMaxBytes);
+
+	FVoxelNoiseTileCacheStats GetStats() const;
+	void ResetStats();
+
+	/**
+	 * Drops every tile, for example after the noise parameters changed.
+	 */
+	void Empty();
+
+private:
+	FVoxelNoiseTileCache();
+
+	struct FKey
+	{
+		uint32 NoiseHash;
+		FIntVector TileCoord;
+
+		bool operator==(const FKey& Other) const
+		{
+			return NoiseHash == Other.NoiseHash && TileCoord == Other.TileCoord;
+		}
+
+		friend uint32 GetTypeHash(const FKey& Key)
+		{
+			return HashCombineFast(Key.NoiseHash, GetTypeHash(Key.TileCoord));
+		}
+	};
+
+	using FLruList = TDoubleLinkedList<FKey>;
+
+	struct FEntry
+	{
+		TSharedRef<const FTile> Tile;
+		FLruList::TDoubleLinkedListNode* LruNode;
+	};
+
+	struct FShard
+	{
+		mutable FCriticalSection Lock;
+		TMap<FKey, FEntry> Entries;
+
+		//Most recently used at the head
+		FLruList Lru;
+		int64 Bytes = 0;
+	};
+
+	static constexpr int32 NumShards = 16;
+
+	FShard& GetShard(const FKey& Key)
+	{
+		return Shards[GetTypeHash(Key) % NumShards];
+	}
+
+	/**
+	 * Evicts from the tail of the shard until it is within its share of the cap. Lock must be held.
+	 */
+	void EvictOverCap(FShard& Shard);
+
+	static int64 GetTileBytes(const FTile& Tile)
+	{
+		return Tile.GetAllocatedSize() + sizeof(FTile);
+	}
+
+	FShard Shards[NumShards];
+
+	std::atomic<int64> MaxBytes;
+	std::atomic<uint64> Hits;
+	std::atomic<uint64> Misses;
+	std::atomic<uint64> Evictions;
+};
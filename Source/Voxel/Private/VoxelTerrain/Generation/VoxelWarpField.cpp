@@ -0,0 +1,85 @@
+#include "VoxelTerrain/Generation/VoxelWarpField.h"
+#include "VoxelNoiseTileCache.h"
+#include "../../FastNoiseLite.h"
+
+namespace
+{
+	//Points per tile side, each point stores its X and Y offset
+	constexpr int32 TileSize = 8;
+}
+
+void FVoxelWarpField::Build(const FastNoiseLite& WarpNoise, uint32 WarpHash, float WorldToNoise, int32 InCellSize, const FIntPoint& MinColumn, const FIntPoint& MaxColumn)
+{
+	CellSize = FMath::Max(InCellSize, 1);
+
+	FirstPoint = FIntPoint(FloorDiv(MinColumn.X), FloorDiv(MinColumn.Y));
+	FIntPoint LastPoint = FIntPoint(FloorDiv(MaxColumn.X), FloorDiv(MaxColumn.Y)) + FIntPoint(1, 1);
+	NumPoints = LastPoint - FirstPoint + FIntPoint(1, 1);
+
+	Offsets.SetNumUninitialized(NumPoints.X * NumPoints.Y);
+
+	uint32 TileHash = HashCombineFast(WarpHash, HashCombineFast(GetTypeHash(CellSize), GetTypeHash(WorldToNoise)));
+
+	for (int32 TileY = FloorDiv(FirstPoint.Y, TileSize); TileY <= FloorDiv(LastPoint.Y, TileSize); TileY++)
+	{
+		for (int32 TileX = FloorDiv(FirstPoint.X, TileSize); TileX <= FloorDiv(LastPoint.X, TileSize); TileX++)
+		{
+			FIntPoint TileOrigin = FIntPoint(TileX, TileY) * TileSize;
+
+			TSharedRef<const FVoxelNoiseTileCache::FTile> Tile = FVoxelNoiseTileCache::Get().FindOrCompute(TileHash, FIntVector(TileX, TileY, 0), [&](FVoxelNoiseTileCache::FTile& OutTile)
+			{
+				OutTile.SetNumUninitialized(TileSize * TileSize * 2);
+				float* Value = OutTile.GetData();
+
+				for (int32 PointY = TileOrigin.Y; PointY < TileOrigin.Y + TileSize; PointY++)
+				{
+					for (int32 PointX = TileOrigin.X; PointX < TileOrigin.X + TileSize; PointX++)
+					{
+						float X = PointX * CellSize * WorldToNoise;
+						float Y = PointY * CellSize * WorldToNoise;
+
+						float WarpedX = X;
+						float WarpedY = Y;
+						WarpNoise.DomainWarp(WarpedX, WarpedY);
+
+						*Value++ = WarpedX - X;
+						*Value++ = WarpedY - Y;
+					}
+				}
+			});
+
+			//Copy the part of the tile this field covers
+			int32 MinX = FMath::Max(FirstPoint.X, TileOrigin.X);
+			int32 MaxX = FMath::Min(LastPoint.X, TileOrigin.X + TileSize - 1);
+			int32 MinY = FMath::Max(FirstPoint.Y, TileOrigin.Y);
+			int32 MaxY = FMath::Min(LastPoint.Y, TileOrigin.Y + TileSize - 1);
+
+			for (int32 PointY = MinY; PointY <= MaxY; PointY++)
+			{
+				for (int32 PointX = MinX; PointX <= MaxX; PointX++)
+				{
+					const float* Source = Tile->GetData() + 2 * ((PointX - TileOrigin.X) + TileSize * (PointY - TileOrigin.Y));
+					Offsets[(PointX - FirstPoint.X) + NumPoints.X * (PointY - FirstPoint.Y)] = FVector2f(Source[0], Source[1]);
+				}
+			}
+		}
+	}
+}
+
+FVector2f FVoxelWarpField::GetOffset(int32 X, int32 Y) const
+{
+	int32 CellX = FloorDiv(X);
+	int32 CellY = FloorDiv(Y);
+
+	int32 Base = (CellX - FirstPoint.X) + NumPoints.X * (CellY - FirstPoint.Y);
+	const FVector2f* Corner = Offsets.GetData() + Base;
+
+	float InvCellSize = 1.0f / CellSize;
+	float FX = (X - CellX * CellSize) * InvCellSize;
+	float FY = (Y - CellY * CellSize) * InvCellSize;
+
+	FVector2f Bottom = FMath::Lerp(Corner[0], Corner[1], FX);
+	FVector2f Top = FMath::Lerp(Corner[NumPoints.X], Corner[NumPoints.X + 1], FX);
+
+	return FMath::Lerp(Bottom, Top, FY);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FastNoiseLite;
+
+/**
+ * Domain warp offsets evaluated every CellSize columns and bilinearly interpolated in between.
+ * 
+ * Aligned to world columns like FVoxelDensityLattice, so a chunk and a single column
+   query get exactly the same offsets. Points are evaluated through FVoxelNoiseTileCache.
+ */
+class FVoxelWarpField
+{
+public:
+	/**
+	 * Evaluates the warp on every point needed to interpolate the columns from MinColumn
+	   to MaxColumn, inclusive, in world block coordinates.
+	 * Columns are scaled by WorldToNoise before warping, offsets are in noise coordinates.
+	 * WarpHash identifies the warp noise and its seed in the tile cache.
+	 */
+	void Build(const FastNoiseLite& WarpNoise, uint32 WarpHash, float WorldToNoise, int32 InCellSize, const FIntPoint& MinColumn, const FIntPoint& MaxColumn);
+
+	/**
+	 * Interpolated offset of a world column inside the built range.
+	 */
+	FVector2f GetOffset(int32 X, int32 Y) const;
+
+private:
+	int32 FloorDiv(int32 Value) const
+	{
+		return FloorDiv(Value, CellSize);
+	}
+
+	static int32 FloorDiv(int32 Value, int32 Divisor)
+	{
+		return Value >= 0 ? Value / Divisor : (Value - Divisor + 1) / Divisor;
+	}
+
+	int32 CellSize = 1;
+
+	//Coordinate of the first evaluated point and number of points along each axis
+	FIntPoint FirstPoint = FIntPoint::ZeroValue;
+	FIntPoint NumPoints = FIntPoint::ZeroValue;
+
+	TArray<FVector2f> Offsets;
+};
@@ -0,0 +1,350 @@
+#include "VoxelTerrain/Lighting/VoxelLightEngine.h"
+#include "Voxel.h"
+#include "../Chunk/FaceTables.h"
+#include "../Blocks/VoxelBlockRegistry.h"
+#include "../../Structs/Block.h"
+
+DECLARE_CYCLE_STAT(TEXT("Sky Light"), STAT_VoxelSkyLight, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("Block Light"), STAT_VoxelBlockLight, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("Light Update"), STAT_VoxelLightUpdate, STATGROUP_Voxel);
+
+namespace
+{
+	/**
+	 * Block indices waiting to spread their light. Every thread keeps its own queue,
+	   so the memory is reused by all chunks lit on it.
+	 */
+	TArray<int32>& GetLightQueue()
+	{
+		static thread_local TArray<int32> Queue;
+		return Queue;
+	}
+
+	/**
+	 * Neighbourhood positions waiting to spread their light in an incremental update, see FVoxelLightNeighborhood::PackPosition.
+	 */
+	TArray<int64>& GetNeighborhoodQueue()
+	{
+		static thread_local TArray<int64> Queue;
+		return Queue;
+	}
+
+	/**
+	 * Blocks that went dark in an incremental update, packed with the light they had in the lowest 4 bits.
+	 */
+	TArray<int64>& GetRemovalQueue()
+	{
+		static thread_local TArray<int64> Queue;
+		return Queue;
+	}
+
+	/**
+	 * Lowest block of every column the sky reaches straight down.
+	 */
+	TArray<int16>& GetSkyFloor()
+	{
+		static thread_local TArray<int16> SkyFloor;
+		return SkyFloor;
+	}
+
+	FIntVector GetFaceOffset(int32 Face)
+	{
+		return FIntVector(VoxelFace::Offsets[Face][0], VoxelFace::Offsets[Face][1], VoxelFace::Offsets[Face][2]);
+	}
+
+	uint8 GetLevel(const FBlock& Block, EVoxelLightChannel Channel)
+	{
+		return Channel == EVoxelLightChannel::Sky ? Block.GetSkyLight() : Block.GetBlockLight();
+	}
+
+	void SetLevel(FBlock& Block, EVoxelLightChannel Channel, uint8 Level)
+	{
+		if (Channel == EVoxelLightChannel::Sky)
+			Block.SetSkyLight(Level);
+		else
+			Block.SetBlockLight(Level);
+	}
+
+	/**
+	 * Level light reaches a neighbour with. Sky light at full level goes straight down without fading.
+	 */
+	uint8 GetSpreadLevel(uint8 Level, int32 Face, EVoxelLightChannel Channel)
+	{
+		bool bIsStraightDown = Channel == EVoxelLightChannel::Sky && VoxelFace::Offsets[Face][2] < 0 && Level == FBlock::MaxLight;
+		return bIsStraightDown ? Level : Level - 1;
+	}
+
+	/**
+	 * Spreads the light of every queued block index into darker blocks inside one chunk.
+	 */
+	void SpreadInChunk(TArray<FBlock>& Blocks, const FVoxelBlockRegistry& Registry, TArray<int32>& Queue, int32 Width, int32 Height, EVoxelLightChannel Channel)
+	{
+		for (int32 Head = 0; Head < Queue.Num(); Head++)
+		{
+			int32 Index = Queue[Head];
+			uint8 Level = GetLevel(Blocks[Index], Channel);
+			if (Level <= 1) continue;
+
+			int32 Column = Index / Height;
+			FIntVector Local = FIntVector(Column % Width, Column / Width, Index % Height);
+
+			for (int32 Face = 0; Face < VoxelFace::NumDirections; Face++)
+			{
+				FIntVector Neighbor = Local + GetFaceOffset(Face);
+
+				if (Neighbor.X < 0 || Neighbor.X >= Width || Neighbor.Y < 0 || Neighbor.Y >= Width || Neighbor.Z < 0 || Neighbor.Z >= Height)
+					continue;
+
+				int32 NeighborIndex = Neighbor.Z + Height * (Neighbor.X + Width * Neighbor.Y);
+				FBlock& NeighborBlock = Blocks[NeighborIndex];
+				if (Registry.IsOpaque(NeighborBlock.Type)) continue;
+
+				uint8 NewLevel = GetSpreadLevel(Level, Face, Channel);
+				if (NewLevel <= GetLevel(NeighborBlock, Channel)) continue;
+
+				SetLevel(NeighborBlock, Channel, NewLevel);
+				Queue.Add(NeighborIndex);
+			}
+		}
+	}
+}
+
+FVoxelLightNeighborhood::FVoxelLightNeighborhood(const FVoxelBlockRegistry& InRegistry, int32 InWidth, int32 InHeight)
+	: Registry(InRegistry)
+{
+	for (int32 Slot = 0; Slot < NumChunks; Slot++)
+	{
+		Chunks[Slot] = nullptr;
+	}
+
+	Width = InWidth;
+	Height = InHeight;
+	ChangedSlots = 0;
+}
+
+FBlock* FVoxelLightNeighborhood::GetBlock(const FIntVector& Position, int32& OutSlot) const
+{
+	if (Position.Z < 0 || Position.Z >= Height) return nullptr;
+	if (Position.X < -Width || Position.X >= 2 * Width) return nullptr;
+	if (Position.Y < -Width || Position.Y >= 2 * Width) return nullptr;
+
+	int32 ChunkX = (Position.X + Width) / Width - 1;
+	int32 ChunkY = (Position.Y + Width) / Width - 1;
+
+	OutSlot = GetSlot(ChunkX, ChunkY);
+	TArray<FBlock>* Blocks = Chunks[OutSlot];
+	if (!Blocks || Blocks->IsEmpty()) return nullptr;
+
+	int32 X = Position.X - ChunkX * Width;
+	int32 Y = Position.Y - ChunkY * Width;
+
+	return &(*Blocks)[Position.Z + Height * (X + Width * Y)];
+}
+
+void FVoxelLightEngine::PropagateSkyLight(TArray<FBlock>& Blocks, const FVoxelBlockRegistry& Registry, const TArray<int16>& ColumnMaxZ, int32 Width, int32 Height)
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelSkyLight);
+
+	TArray<int32>& Queue = GetLightQueue();
+	Queue.Reset();
+
+	TArray<int16>& SkyFloor = GetSkyFloor();
+	SkyFloor.SetNumUninitialized(Width * Width);
+
+	//Columns are lit from the top down to the first block that stops light, everything below starts dark
+	for (int32 Column = 0; Column < Width * Width; Column++)
+	{
+		FBlock* ColumnBlocks = Blocks.GetData() + Column * Height;
+
+		int32 Floor = ColumnMaxZ[Column] + 1;
+		while (Floor > 0 && !Registry.IsOpaque(ColumnBlocks[Floor - 1].Type))
+		{
+			Floor--;
+		}
+
+		for (int32 Z = 0; Z < Height; Z++)
+		{
+			ColumnBlocks[Z].SetSkyLight(Z >= Floor ? FBlock::MaxLight : 0);
+		}
+
+		SkyFloor[Column] = Floor;
+	}
+
+	//Only sky blocks next to a column lit less deep can light anything the column pass did not
+	for (int32 Y = 0; Y < Width; Y++)
+	{
+		for (int32 X = 0; X < Width; X++)
+		{
+			int32 Column = X + Width * Y;
+			int32 NeighborFloor = 0;
+
+			if (X > 0) NeighborFloor = FMath::Max<int32>(NeighborFloor, SkyFloor[Column - 1]);
+			if (X < Width - 1) NeighborFloor = FMath::Max<int32>(NeighborFloor, SkyFloor[Column + 1]);
+			if (Y > 0) NeighborFloor = FMath::Max<int32>(NeighborFloor, SkyFloor[Column - Width]);
+			if (Y < Width - 1) NeighborFloor = FMath::Max<int32>(NeighborFloor, SkyFloor[Column + Width]);
+
+			int32 LastZ = FMath::Min(NeighborFloor - 1, Height - 1);
+			for (int32 Z = SkyFloor[Column]; Z <= LastZ; Z++)
+			{
+				Queue.Add(Z + Height * Column);
+			}
+		}
+	}
+
+	SpreadInChunk(Blocks, Registry, Queue, Width, Height, EVoxelLightChannel::Sky);
+}
+
+void FVoxelLightEngine::PropagateBlockLight(TArray<FBlock>& Blocks, const FVoxelBlockRegistry& Registry, const TArray<int16>& ColumnMinZ, const TArray<int16>& ColumnMaxZ, int32 Width, int32 Height)
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelBlockLight);
+
+	TArray<int32>& Queue = GetLightQueue();
+	Queue.Reset();
+
+	for (FBlock& Block : Blocks)
+	{
+		Block.SetBlockLight(0);
+	}
+
+	//Emissive blocks are solid, so they lie within the column bounds
+	for (int32 Column = 0; Column < Width * Width; Column++)
+	{
+		for (int32 Z = ColumnMinZ[Column]; Z <= ColumnMaxZ[Column]; Z++)
+		{
+			int32 Index = Z + Height * Column;
+			uint8 Emission = Registry.GetEmission(Blocks[Index].Type);
+			if (Emission == 0) continue;
+
+			Blocks[Index].SetBlockLight(Emission);
+			Queue.Add(Index);
+		}
+	}
+
+	SpreadInChunk(Blocks, Registry, Queue, Width, Height, EVoxelLightChannel::Block);
+}
+
+void FVoxelLightEngine::UpdateLight(FVoxelLightNeighborhood& Neighborhood, const FIntVector& Position)
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelLightUpdate);
+
+	UpdateChannel(Neighborhood, Position, EVoxelLightChannel::Sky);
+	UpdateChannel(Neighborhood, Position, EVoxelLightChannel::Block);
+}
+
+void FVoxelLightEngine::UpdateChannel(FVoxelLightNeighborhood& Neighborhood, const FIntVector& Position, EVoxelLightChannel Channel)
+{
+	TArray<int64>& Queue = GetNeighborhoodQueue();
+	TArray<int64>& RemovalQueue = GetRemovalQueue();
+	Queue.Reset();
+	RemovalQueue.Reset();
+
+	int32 Slot;
+	FBlock* Block = Neighborhood.GetBlock(Position, Slot);
+	if (!Block) return;
+
+	uint8 OldLevel = GetLevel(*Block, Channel);
+	if (OldLevel > 0)
+	{
+		SetLevel(*Block, Channel, 0);
+		Neighborhood.MarkChanged(Slot);
+		RemovalQueue.Add((Neighborhood.PackPosition(Position) << 4) | OldLevel);
+	}
+
+	const FVoxelBlockRegistry& Registry = Neighborhood.Registry;
+
+	uint8 Emission = Channel == EVoxelLightChannel::Block ? Registry.GetEmission(Block->Type) : 0;
+	if (Emission > 0)
+	{
+		SetLevel(*Block, Channel, Emission);
+		Neighborhood.MarkChanged(Slot);
+		Queue.Add(Neighborhood.PackPosition(Position));
+	}
+	else if (!Registry.IsOpaque(Block->Type))
+	{
+		//Nothing above the chunk blocks the sky
+		if (Channel == EVoxelLightChannel::Sky && Position.Z == Neighborhood.Height - 1)
+		{
+			SetLevel(*Block, Channel, FBlock::MaxLight);
+			Neighborhood.MarkChanged(Slot);
+			Queue.Add(Neighborhood.PackPosition(Position));
+		}
+
+		for (int32 Face = 0; Face < VoxelFace::NumDirections; Face++)
+		{
+			FIntVector Neighbor = Position + GetFaceOffset(Face);
+
+			int32 NeighborSlot;
+			FBlock* NeighborBlock = Neighborhood.GetBlock(Neighbor, NeighborSlot);
+			if (!NeighborBlock || GetLevel(*NeighborBlock, Channel) == 0) continue;
+
+			Queue.Add(Neighborhood.PackPosition(Neighbor));
+		}
+	}
+
+	//Blocks darker than the one that went dark, or lit straight down through it, got their light from it
+	for (int32 Head = 0; Head < RemovalQueue.Num(); Head++)
+	{
+		FIntVector Removed = Neighborhood.UnpackPosition(RemovalQueue[Head] >> 4);
+		uint8 Level = RemovalQueue[Head] & 0x0F;
+
+		for (int32 Face = 0; Face < VoxelFace::NumDirections; Face++)
+		{
+			FIntVector Neighbor = Removed + GetFaceOffset(Face);
+
+			int32 NeighborSlot;
+			FBlock* NeighborBlock = Neighborhood.GetBlock(Neighbor, NeighborSlot);
+			if (!NeighborBlock) continue;
+
+			uint8 NeighborLevel = GetLevel(*NeighborBlock, Channel);
+			if (NeighborLevel == 0) continue;
+
+			//Emissive blocks keep the light they give off themselves
+			bool bIsEmissive = Registry.GetEmission(NeighborBlock->Type) > 0;
+			bool bWasLitByRemoved = NeighborLevel < Level || GetSpreadLevel(Level, Face, Channel) == Level;
+
+			if (!bIsEmissive && bWasLitByRemoved)
+			{
+				SetLevel(*NeighborBlock, Channel, 0);
+				Neighborhood.MarkChanged(NeighborSlot);
+				RemovalQueue.Add((Neighborhood.PackPosition(Neighbor) << 4) | NeighborLevel);
+				continue;
+			}
+
+			//Lit from elsewhere, so it fills the dark area back in
+			Queue.Add(Neighborhood.PackPosition(Neighbor));
+		}
+	}
+
+	SpreadLight(Neighborhood, Queue, Channel);
+}
+
+void FVoxelLightEngine::SpreadLight(FVoxelLightNeighborhood& Neighborhood, TArray<int64>& Queue, EVoxelLightChannel Channel)
+{
+	for (int32 Head = 0; Head < Queue.Num(); Head++)
+	{
+		FIntVector Position = Neighborhood.UnpackPosition(Queue[Head]);
+
+		int32 Slot;
+		FBlock* Block = Neighborhood.GetBlock(Position, Slot);
+		if (!Block) continue;
+
+		uint8 Level = GetLevel(*Block, Channel);
+		if (Level <= 1) continue;
+
+		for (int32 Face = 0; Face < VoxelFace::NumDirections; Face++)
+		{
+			FIntVector Neighbor = Position + GetFaceOffset(Face);
+
+			int32 NeighborSlot;
+			FBlock* NeighborBlock = Neighborhood.GetBlock(Neighbor, NeighborSlot);
+			if (!NeighborBlock || Neighborhood.Registry.IsOpaque(NeighborBlock->Type)) continue;
+
+			uint8 NewLevel = GetSpreadLevel(Level, Face, Channel);
+			if (NewLevel <= GetLevel(*NeighborBlock, Channel)) continue;
+
+			SetLevel(*NeighborBlock, Channel, NewLevel);
+			Neighborhood.MarkChanged(NeighborSlot);
+			Queue.Add(Neighborhood.PackPosition(Neighbor));
+		}
+	}
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FBlock;
+class FVoxelBlockRegistry;
+
+/**
+ * Blocks of a chunk and its eight neighbours, as seen by an incremental light update.
+ * 
+ * Positions are local to the center chunk and may reach one chunk past it on every side.
+   Light from a single block never travels further than FBlock::MaxLight blocks, so for
+   chunks at least that wide the update cannot leave the neighbourhood.
+ */
+struct FVoxelLightNeighborhood
+{
+	public:
+		static constexpr int32 NumChunks = 9;
+
+		FVoxelLightNeighborhood(const FVoxelBlockRegistry& InRegistry, int32 InWidth, int32 InHeight);
+
+		/**
+		 * Slot of the chunk at an offset of -1 to 1 chunks from the center chunk.
+		 */
+		static int32 GetSlot(int32 ChunkX, int32 ChunkY)
+		{
+			return (ChunkX + 1) + 3 * (ChunkY + 1);
+		}
+
+		/**
+		 * Block at a position local to the center chunk, nullptr if the chunk holding it is not loaded.
+		 */
+		FBlock* GetBlock(const FIntVector& Position, int32& OutSlot) const;
+
+		void MarkChanged(int32 Slot) { ChangedSlots |= 1u << Slot; }
+		bool IsChanged(int32 Slot) const { return (ChangedSlots & (1u << Slot)) != 0; }
+
+		/**
+		 * Position packed into a single queue entry and back.
+		 * Nine of the largest chunks hold more blocks than an int32 counts, so entries are 64 bit.
+		 */
+		int64 PackPosition(const FIntVector& Position) const
+		{
+			return Position.Z + int64(Height) * ((Position.X + Width) + int64(3 * Width) * (Position.Y + Width));
+		}
+
+		FIntVector UnpackPosition(int64 Packed) const
+		{
+			int64 Column = Packed / Height;
+			return FIntVector(int32(Column % (3 * Width)) - Width, int32(Column / (3 * Width)) - Width, int32(Packed % Height));
+		}
+
+		//Blocks of every chunk, nullptr where no chunk is loaded
+		TArray<FBlock>* Chunks[NumChunks];
+
+		const FVoxelBlockRegistry& Registry;
+
+		int32 Width;
+		int32 Height;
+
+	private:
+		uint32 ChangedSlots;
+};
+
+/**
+ * The two kinds of light packed into FBlock::Light.
+ */
+enum class EVoxelLightChannel : uint8
+{
+	//Light coming down from above the chunk, high nibble
+	Sky,
+	//Light given off by emissive blocks, low nibble
+	Block
+};
+
+/**
+ * Light propagation over the blocks of one chunk.
+ * 
+ * Light is stored in FBlock::Light, sky light in the high nibble and the light of emissive
+   blocks in the low nibble. Each channel spreads on its own with a breadth first flood fill
+   over a queue of block indices, so every block is visited at most once per light level.
+ * Light passes through blocks that are not opaque in the block registry. Emissive blocks
+   keep their own level in the block channel.
+ * All functions only work on the arrays they are given and can run on any thread.
+ */
+class FVoxelLightEngine
+{
+public:
+	/**
+	 * Fills the sky light of every block in the chunk.
+	 * Blocks above the highest block of their column that stops light see the sky at full light,
+	   from there light spreads sideways and down into overhangs and caves, losing one
+	   level per block. Light going straight down at full level does not fade.
+	 * Blocks are stored column by column (Z changes fastest), ColumnMaxZ is the highest solid
+	   block of every column, below 0 for empty columns.
+	 */
+	static void PropagateSkyLight(TArray<FBlock>& Blocks, const FVoxelBlockRegistry& Registry, const TArray<int16>& ColumnMaxZ, int32 Width, int32 Height);
+
+	/**
+	 * Fills the block light of every block in the chunk from the emissive blocks in it,
+	   losing one level per block. Only columns between ColumnMinZ and ColumnMaxZ are searched.
+	 */
+	static void PropagateBlockLight(TArray<FBlock>& Blocks, const FVoxelBlockRegistry& Registry, const TArray<int16>& ColumnMinZ, const TArray<int16>& ColumnMaxZ, int32 Width, int32 Height);
+
+	/**
+	 * Updates both light channels after the block at Position, local to the center chunk, changed its type.
+	 * Light that came through or from the old block is taken away first: every block lit by it
+	   goes dark in a removal pass, and lit blocks found at the edge of the dark area spread their
+	   light back in. A block that lets light through is then lit from its neighbours, an emissive block
+	   from itself. Only blocks whose light depends on the edit are visited.
+	 * Chunks with blocks whose light changed are marked in the neighbourhood.
+	 */
+	static void UpdateLight(FVoxelLightNeighborhood& Neighborhood, const FIntVector& Position);
+
+private:
+	static void UpdateChannel(FVoxelLightNeighborhood& Neighborhood, const FIntVector& Position, EVoxelLightChannel Channel);
+
+	/**
+	 * Spreads the light of every queued neighbourhood position into darker blocks around it that let light through.
+	 */
+	static void SpreadLight(FVoxelLightNeighborhood& Neighborhood, TArray<int64>& Queue, EVoxelLightChannel Channel);
+};
@@ -0,0 +1,195 @@
+#include "VoxelTerrain/Storage/VoxelBakedWorld.h"
+#include "../../Structs/Block.h"
+#include "../../Structs/VoxelBitset.h"
+#include "../../Structs/VoxelChunkBuffer.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+#include "Async/MappedFileHandle.h"
+
+static_assert(sizeof(FBlock) == 6, "Baked worlds store FBlock as raw memory, bump FVoxelBakedWorld::Version when its layout changes");
+static_assert(sizeof(FVoxelBakedWorld::FHeader) == 64, "Baked world header is expected to be 64 bytes");
+
+FVoxelBakedWorld::FVoxelBakedWorld()
+{
+	Header = nullptr;
+	Offsets = nullptr;
+	Data = nullptr;
+	DataSize = 0;
+}
+
+FVoxelBakedWorld::~FVoxelBakedWorld()
+{
+	//Region has to be unmapped before its file handle is closed
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+TSharedPtr<FVoxelBakedWorld> FVoxelBakedWorld::Open(const FString& Path)
+{
+	TSharedPtr<FVoxelBakedWorld> World = MakeShareable(new FVoxelBakedWorld());
+
+	World->MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	if (!World->MappedFile) return nullptr;
+
+	World->MappedRegion.Reset(World->MappedFile->MapRegion());
+	if (!World->MappedRegion) return nullptr;
+
+	const uint8* Mapped = World->MappedRegion->GetMappedPtr();
+	int64 MappedSize = World->MappedRegion->GetMappedSize();
+	if (MappedSize < int64(sizeof(FHeader))) return nullptr;
+
+	const FHeader* Header = reinterpret_cast<const FHeader*>(Mapped);
+	if (Header->Magic != Magic || Header->Version != Version || Header->BlockStride != sizeof(FBlock) ||
+		Header->BorderWords != GetBorderWords(Header->Width, Header->Height))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Not a compatible baked world: %s"), *Path);
+		return nullptr;
+	}
+
+	int64 TableSize = int64(Header->SizeX) * Header->SizeY * sizeof(uint64);
+	if (Header->SizeX <= 0 || Header->SizeY <= 0 || int64(sizeof(FHeader)) + TableSize > MappedSize) return nullptr;
+
+	World->Header = Header;
+	World->Offsets = reinterpret_cast<const uint64*>(Mapped + sizeof(FHeader));
+	World->Data = Mapped;
+	World->DataSize = MappedSize;
+
+	return World;
+}
+
+const FBlock* FVoxelBakedWorld::FindChunk(const FIntPoint& ChunkCoord) const
+{
+	int32 X = ChunkCoord.X - Header->MinChunkX;
+	int32 Y = ChunkCoord.Y - Header->MinChunkY;
+	if (X < 0 || X >= Header->SizeX || Y < 0 || Y >= Header->SizeY) return nullptr;
+
+	uint64 Offset = Offsets[X + Y * Header->SizeX];
+	if (Offset == 0) return nullptr;
+
+	int64 ChunkBytes = GetBorderOffset(Header->Width, Header->Height) + Header->BorderWords * sizeof(uint64);
+	if (int64(Offset) + ChunkBytes > DataSize) return nullptr;
+
+	return reinterpret_cast<const FBlock*>(Data + Offset);
+}
+
+bool FVoxelBakedWorld::LoadChunk(const FIntPoint& ChunkCoord, int32 Width, int32 Height, TArray<FBlock>& OutBlocks, FVoxelBitset* OutBorderSolid) const
+{
+	if (Header->Width != Width || Header->Height != Height) return false;
+
+	const FBlock* ChunkBlocks = FindChunk(ChunkCoord);
+	if (!ChunkBlocks) return false;
+
+	OutBlocks.SetNumUninitialized(Width * Width * Height);
+	FMemory::Memcpy(OutBlocks.GetData(), ChunkBlocks, OutBlocks.Num() * sizeof(FBlock));
+
+	if (OutBorderSolid)
+	{
+		const uint8* BorderWords = reinterpret_cast<const uint8*>(ChunkBlocks) + GetBorderOffset(Width, Height);
+
+		OutBorderSolid->Init(FVoxelChunkBuffer::NumBorderSides * Width * Height);
+		FMemory::Memcpy(OutBorderSolid->GetWords(), BorderWords, OutBorderSolid->NumWords() * sizeof(uint64));
+	}
+
+	return true;
+}
+
+int64 FVoxelBakedWorld::GetBorderOffset(int32 Width, int32 Height)
+{
+	return Align(int64(Width) * Width * Height * sizeof(FBlock), sizeof(uint64));
+}
+
+int32 FVoxelBakedWorld::GetBorderWords(int32 Width, int32 Height)
+{
+	return (FVoxelChunkBuffer::NumBorderSides * Width * Height + 63) / 64;
+}
+
+const FVoxelBakedWorld::FHeader& FVoxelBakedWorld::GetHeader() const
+{
+	return *Header;
+}
+
+FVoxelBakedWorldWriter::FVoxelBakedWorldWriter(const FString& InPath, int32 InWidth, int32 InHeight, const FIntPoint& InMinChunk, const FIntPoint& InSize, uint64 InWorldHash)
+{
+	Path = InPath;
+	TempPath = InPath + TEXT(".tmp");
+
+	FMemory::Memzero(Header);
+	Header.Magic = FVoxelBakedWorld::Magic;
+	Header.Version = FVoxelBakedWorld::Version;
+	Header.Width = InWidth;
+	Header.Height = InHeight;
+	Header.BlockStride = sizeof(FBlock);
+	Header.MinChunkX = InMinChunk.X;
+	Header.MinChunkY = InMinChunk.Y;
+	Header.SizeX = InSize.X;
+	Header.SizeY = InSize.Y;
+	Header.BorderWords = FVoxelBakedWorld::GetBorderWords(InWidth, InHeight);
+	Header.WorldHash = InWorldHash;
+
+	Offsets.Init(0, InSize.X * InSize.Y);
+
+	//Every chunk gets a fixed, aligned slot, so chunks can be written in any order
+	ChunkBytes = Align(FVoxelBakedWorld::GetBorderOffset(InWidth, InHeight) + Header.BorderWords * sizeof(uint64), FVoxelBakedWorld::DataAlignment);
+	DataStart = Align(int64(sizeof(FVoxelBakedWorld::FHeader)) + Offsets.Num() * sizeof(uint64), FVoxelBakedWorld::DataAlignment);
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Path), true);
+	File.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*TempPath));
+}
+
+FVoxelBakedWorldWriter::~FVoxelBakedWorldWriter()
+{
+	if (!File) return;
+
+	File.Reset();
+	IFileManager::Get().Delete(*TempPath);
+}
+
+bool FVoxelBakedWorldWriter::IsValid() const
+{
+	return File.IsValid();
+}
+
+bool FVoxelBakedWorldWriter::WriteChunk(const FIntPoint& ChunkCoord, const TArray<FBlock>& Blocks, const FVoxelBitset& BorderSolid)
+{
+	int32 X = ChunkCoord.X - Header.MinChunkX;
+	int32 Y = ChunkCoord.Y - Header.MinChunkY;
+	if (X < 0 || X >= Header.SizeX || Y < 0 || Y >= Header.SizeY) return false;
+	if (Blocks.Num() != Header.Width * Header.Width * Header.Height) return false;
+	if (BorderSolid.NumWords() != Header.BorderWords) return false;
+
+	int32 Slot = X + Y * Header.SizeX;
+	int64 Offset = DataStart + Slot * ChunkBytes;
+
+	FScopeLock Lock(&FileLock);
+	if (!File) return false;
+
+	if (!File->Seek(Offset)) return false;
+	if (!File->Write(reinterpret_cast<const uint8*>(Blocks.GetData()), Blocks.Num() * sizeof(FBlock))) return false;
+	if (!File->Seek(Offset + FVoxelBakedWorld::GetBorderOffset(Header.Width, Header.Height))) return false;
+	if (!File->Write(reinterpret_cast<const uint8*>(BorderSolid.GetWords()), BorderSolid.NumWords() * sizeof(uint64))) return false;
+
+	Offsets[Slot] = Offset;
+
+	return true;
+}
+
+bool FVoxelBakedWorldWriter::Close()
+{
+	FScopeLock Lock(&FileLock);
+	if (!File) return false;
+
+	bool bWritten = File->Seek(0) &&
+		File->Write(reinterpret_cast<const uint8*>(&Header), sizeof(Header)) &&
+		File->Write(reinterpret_cast<const uint8*>(Offsets.GetData()), Offsets.Num() * sizeof(uint64));
+
+	File.Reset();
+
+	if (!bWritten)
+	{
+		IFileManager::Get().Delete(*TempPath);
+		return false;
+	}
+
+	return IFileManager::Get().Move(*Path, *TempPath, true, true);
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FBlock;
+struct FVoxelBitset;
+class IMappedFileHandle;
+class IMappedFileRegion;
+class IFileHandle;
+
+/**
+ * Read only world of pre-generated chunks, memory mapped from a single file.
+ * 
+ * Blocks of a chunk are stored exactly as they are laid out in chunk storage,
+   so loading a chunk is a single copy out of the mapping with no parsing.
+ * 
+ * Layout: header, offset table with one entry per chunk of the baked rectangle
+   (0 if the chunk is missing), then a slot per chunk aligned to DataAlignment. A slot holds
+   the raw blocks followed by the words of its border bits, see FVoxelChunkBuffer::BorderSolid.
+ */
+class FVoxelBakedWorld
+{
+public:
+	static constexpr uint32 Magic = 0x57425856; // "VXBW"
+	static constexpr uint32 Version = 2;
+	static constexpr int64 DataAlignment = 4096;
+
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		int32 Width;
+		int32 Height;
+		int32 BlockStride;
+		int32 MinChunkX;
+		int32 MinChunkY;
+		int32 SizeX;
+		int32 SizeY;
+
+		//Words of border bits stored after the blocks of every chunk
+		int32 BorderWords;
+
+		//FVoxelGenerator::HashWorld of the seed and parameters the world was baked with
+		uint64 WorldHash;
+		uint32 Padding[4];
+	};
+
+	~FVoxelBakedWorld();
+
+	/**
+	 * Maps a baked world file. Returns nullptr if it is missing or not a valid baked world.
+	 */
+	static TSharedPtr<FVoxelBakedWorld> Open(const FString& Path);
+
+	/**
+	 * Returns the blocks of a chunk inside the mapping, or nullptr if the chunk was not baked.
+	 */
+	const FBlock* FindChunk(const FIntPoint& ChunkCoord) const;
+
+	/**
+	 * Copies the blocks of a chunk into chunk storage, and its border bits into OutBorderSolid when given.
+	 * Returns false if the chunk was not baked or the world was baked with different chunk dimensions.
+	 */
+	bool LoadChunk(const FIntPoint& ChunkCoord, int32 Width, int32 Height, TArray<FBlock>& OutBlocks, FVoxelBitset* OutBorderSolid = nullptr) const;
+
+	/**
+	 * Offset of the border bits inside a chunk slot, right after the blocks.
+	 */
+	static int64 GetBorderOffset(int32 Width, int32 Height);
+
+	/**
+	 * Words of border bits of a chunk.
+	 */
+	static int32 GetBorderWords(int32 Width, int32 Height);
+
+	const FHeader& GetHeader() const;
+
+private:
+	FVoxelBakedWorld();
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	const FHeader* Header;
+	const uint64* Offsets;
+	const uint8* Data;
+	int64 DataSize;
+};
+
+/**
+ * Writes a baked world file. Chunks may be written in any order and from any thread.
+ * The file is written next to the target and moved in place by Close.
+ */
+class FVoxelBakedWorldWriter
+{
+public:
+	FVoxelBakedWorldWriter(const FString& InPath, int32 InWidth, int32 InHeight, const FIntPoint& InMinChunk, const FIntPoint& InSize, uint64 InWorldHash);
+	~FVoxelBakedWorldWriter();
+
+	bool IsValid() const;
+
+	/**
+	 * Writes the blocks and border bits of a chunk inside the baked rectangle.
+	 */
+	bool WriteChunk(const FIntPoint& ChunkCoord, const TArray<FBlock>& Blocks, const FVoxelBitset& BorderSolid);
+
+	/**
+	 * Writes the offset table and replaces the target file.
+	 */
+	bool Close();
+
+private:
+	FString Path;
+	FString TempPath;
+	TUniquePtr<IFileHandle> File;
+	FVoxelBakedWorld::FHeader Header;
+	TArray<uint64> Offsets;
+	int64 ChunkBytes;
+	int64 DataStart;
+	FCriticalSection FileLock;
+};
@@ -0,0 +1,358 @@
+#include "VoxelTerrain/Storage/VoxelRegionStore.h"
+#include "../../Structs/Block.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	constexpr uint32 RegionMagic = 0x47525856; // "VXRG"
+	constexpr uint32 RegionVersion = 1;
+
+	//Offset, compressed size and uncompressed size of every chunk slot
+	constexpr int32 RegionEntrySize = 3 * sizeof(uint32);
+	constexpr int32 RegionHeaderSize = 3 * sizeof(uint32) + FVoxelRegionStore::RegionSize * FVoxelRegionStore::RegionSize * RegionEntrySize;
+}
+
+FVoxelRegionStore::FVoxelRegionStore(const FString& InDirectory)
+{
+	Directory = InDirectory;
+	FlushCount = 0;
+	EvictionCount = 0;
+	IFileManager::Get().MakeDirectory(*Directory, true);
+}
+
+bool FVoxelRegionStore::LoadChunk(const FIntPoint& ChunkCoord, int32 Width, int32 Height, TArray<FBlock>& OutBlocks, FVoxelBitset* OutBorderSolid)
+{
+	FVoxelBitset BorderSolid;
+	if (!OutBorderSolid)
+		OutBorderSolid = &BorderSolid;
+
+	OutBorderSolid->Reset();
+
+	{
+		FScopeLock Lock(&RegionsLock);
+
+		if (auto Pending = PendingChunks.Find(ChunkCoord))
+		{
+			if ((*Pending)->Width != Width || (*Pending)->Height != Height) return false;
+
+			OutBlocks = (*Pending)->Blocks;
+			*OutBorderSolid = (*Pending)->BorderSolid;
+			return true;
+		}
+	}
+
+	TSharedPtr<FRegion> Region = FindOrLoadRegion(GetRegionCoord(ChunkCoord));
+
+	FChunkPayload Payload;
+	{
+		FScopeLock Lock(&RegionsLock);
+		Payload = Region->Payloads[GetRegionSlot(ChunkCoord)];
+	}
+
+	if (Payload.Data.IsEmpty()) return false;
+
+	TArray<uint8> Raw;
+	Raw.SetNumUninitialized(Payload.UncompressedSize);
+	if (!FCompression::UncompressMemory(NAME_Zlib, Raw.GetData(), Raw.Num(), Payload.Data.GetData(), Payload.Data.Num()))
+		return false;
+
+	FMemoryReader Ar(Raw);
+	int32 StoredWidth = 0;
+	int32 StoredHeight = 0;
+	Ar << StoredWidth << StoredHeight;
+	if (StoredWidth != Width || StoredHeight != Height) return false;
+
+	OutBlocks.SetNum(Width * Width * Height);
+	for (FBlock& Block : OutBlocks)
+	{
+		Ar << Block;
+	}
+
+	//Chunks saved before border data existed end right after their blocks
+	uint8 bHasBorder = 0;
+	if (!Ar.AtEnd())
+		Ar << bHasBorder;
+
+	if (bHasBorder)
+		Ar << *OutBorderSolid;
+
+	return !Ar.IsError();
+}
+
+void FVoxelRegionStore::SaveChunk(const FIntPoint& ChunkCoord, int32 Width, int32 Height, const TArray<FBlock>& Blocks, const FVoxelBitset* BorderSolid)
+{
+	TSharedPtr<FPendingChunk> Pending = MakeShared<FPendingChunk>();
+	Pending->Blocks = Blocks;
+	if (BorderSolid)
+		Pending->BorderSolid = *BorderSolid;
+	Pending->Width = Width;
+	Pending->Height = Height;
+
+	{
+		FScopeLock Lock(&RegionsLock);
+		PendingChunks.Add(ChunkCoord, Pending);
+	}
+
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Store = AsShared(), ChunkCoord]()
+	{
+		Store->CompressPendingChunk(ChunkCoord);
+	});
+}
+
+void FVoxelRegionStore::CompressPendingChunk(const FIntPoint& ChunkCoord)
+{
+	TSharedPtr<FPendingChunk> Pending;
+	{
+		FScopeLock Lock(&RegionsLock);
+
+		auto Found = PendingChunks.Find(ChunkCoord);
+		if (!Found) return;
+
+		Pending = *Found;
+	}
+
+	TArray<uint8> Raw;
+	FMemoryWriter Ar(Raw);
+	Ar << Pending->Width << Pending->Height;
+	for (FBlock& Block : Pending->Blocks)
+	{
+		Ar << Block;
+	}
+
+	uint8 bHasBorder = Pending->BorderSolid.Num() > 0 ? 1 : 0;
+	Ar << bHasBorder;
+	if (bHasBorder)
+		Ar << Pending->BorderSolid;
+
+	FChunkPayload Payload;
+	Payload.UncompressedSize = Raw.Num();
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, Raw.Num());
+	Payload.Data.SetNumUninitialized(CompressedSize);
+	if (!FCompression::CompressMemory(NAME_Zlib, Payload.Data.GetData(), CompressedSize, Raw.GetData(), Raw.Num()))
+		return;
+
+	Payload.Data.SetNum(CompressedSize);
+
+	FIntPoint RegionCoord = GetRegionCoord(ChunkCoord);
+
+	while (true)
+	{
+		TSharedPtr<FRegion> Region = FindOrLoadRegion(RegionCoord);
+
+		FScopeLock Lock(&RegionsLock);
+
+		//A newer save of the chunk replaced this one while compressing
+		auto Current = PendingChunks.Find(ChunkCoord);
+		if (!Current || *Current != Pending) return;
+
+		//The region was dropped after it was found, the payload has to go into the one in memory
+		if (Regions.FindRef(RegionCoord) != Region) continue;
+
+		Region->Payloads[GetRegionSlot(ChunkCoord)] = MoveTemp(Payload);
+		Region->bIsDirty = true;
+		Region->LastUsedFlush = FlushCount;
+
+		PendingChunks.Remove(ChunkCoord);
+		return;
+	}
+}
+
+void FVoxelRegionStore::Flush()
+{
+	FScopeLock FlushScope(&FlushLock);
+
+	TArray<FIntPoint> PendingCoords;
+	{
+		FScopeLock Lock(&RegionsLock);
+		PendingChunks.GenerateKeyArray(PendingCoords);
+	}
+
+	for (const FIntPoint& ChunkCoord : PendingCoords)
+	{
+		CompressPendingChunk(ChunkCoord);
+	}
+
+	TArray<TPair<FIntPoint, TArray<FChunkPayload>>> DirtyRegions;
+	{
+		FScopeLock Lock(&RegionsLock);
+
+		for (auto& Pair : Regions)
+		{
+			if (!Pair.Value->bIsDirty) continue;
+
+			DirtyRegions.Emplace(Pair.Key, Pair.Value->Payloads);
+			Pair.Value->bIsDirty = false;
+		}
+	}
+
+	for (const auto& Pair : DirtyRegions)
+	{
+		if (WriteRegionFile(GetRegionPath(Pair.Key), Pair.Value)) continue;
+
+		UE_LOG(LogTemp, Warning, TEXT("Failed to write region %d, %d"), Pair.Key.X, Pair.Key.Y);
+
+		FScopeLock Lock(&RegionsLock);
+		Regions[Pair.Key]->bIsDirty = true;
+	}
+
+	//Regions left untouched for a whole flush are on disk as they are, so they can be read again when needed
+	FScopeLock Lock(&RegionsLock);
+
+	for (auto It = Regions.CreateIterator(); It; ++It)
+	{
+		if (It.Value()->bIsDirty || It.Value()->LastUsedFlush == FlushCount) continue;
+
+		It.RemoveCurrent();
+		EvictionCount++;
+	}
+
+	FlushCount++;
+}
+
+const FString& FVoxelRegionStore::GetDirectory() const
+{
+	return Directory;
+}
+
+TSharedPtr<FVoxelRegionStore::FRegion> FVoxelRegionStore::FindOrLoadRegion(const FIntPoint& RegionCoord)
+{
+	while (true)
+	{
+		uint32 Evictions;
+		{
+			FScopeLock Lock(&RegionsLock);
+
+			if (auto Region = Regions.Find(RegionCoord))
+			{
+				(*Region)->LastUsedFlush = FlushCount;
+				return *Region;
+			}
+
+			Evictions = EvictionCount;
+		}
+
+		//Read without the lock, so other threads are not held up by the file
+		TSharedPtr<FRegion> Region = MakeShared<FRegion>();
+		if (!ReadRegionFile(GetRegionPath(RegionCoord), *Region))
+		{
+			Region->Payloads.Empty();
+			Region->Payloads.SetNum(RegionSize * RegionSize);
+		}
+
+		FScopeLock Lock(&RegionsLock);
+
+		//Another thread read it meanwhile, its copy may already have changes
+		if (auto Loaded = Regions.Find(RegionCoord))
+		{
+			(*Loaded)->LastUsedFlush = FlushCount;
+			return *Loaded;
+		}
+
+		//A region dropped meanwhile may have been written after the file was read
+		if (EvictionCount != Evictions) continue;
+
+		Region->LastUsedFlush = FlushCount;
+		Regions.Add(RegionCoord, Region);
+
+		return Region;
+	}
+}
+
+bool FVoxelRegionStore::ReadRegionFile(const FString& Path, FRegion& OutRegion) const
+{
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *Path, FILEREAD_Silent)) return false;
+	if (FileData.Num() < RegionHeaderSize) return false;
+
+	FMemoryReader Ar(FileData);
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	int32 StoredRegionSize = 0;
+	Ar << Magic << Version << StoredRegionSize;
+
+	if (Magic != RegionMagic || Version != RegionVersion || StoredRegionSize != RegionSize)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Ignoring region file with unknown format: %s"), *Path);
+		return false;
+	}
+
+	OutRegion.Payloads.SetNum(RegionSize * RegionSize);
+
+	for (FChunkPayload& Payload : OutRegion.Payloads)
+	{
+		uint32 Offset = 0;
+		uint32 CompressedSize = 0;
+		Ar << Offset << CompressedSize << Payload.UncompressedSize;
+
+		if (CompressedSize == 0) continue;
+		if (uint64(Offset) + CompressedSize > uint64(FileData.Num())) return false;
+
+		Payload.Data.Append(FileData.GetData() + Offset, CompressedSize);
+	}
+
+	return !Ar.IsError();
+}
+
+bool FVoxelRegionStore::WriteRegionFile(const FString& Path, const TArray<FChunkPayload>& Payloads) const
+{
+	TArray<uint8> FileData;
+	FMemoryWriter Ar(FileData);
+
+	uint32 Magic = RegionMagic;
+	uint32 Version = RegionVersion;
+	int32 StoredRegionSize = RegionSize;
+	Ar << Magic << Version << StoredRegionSize;
+
+	//Payloads follow the table in slot order
+	uint32 Offset = RegionHeaderSize;
+	for (const FChunkPayload& Payload : Payloads)
+	{
+		uint32 CompressedSize = Payload.Data.Num();
+		uint32 UncompressedSize = Payload.UncompressedSize;
+		uint32 EntryOffset = CompressedSize > 0 ? Offset : 0;
+		Ar << EntryOffset << CompressedSize << UncompressedSize;
+
+		Offset += CompressedSize;
+	}
+
+	for (const FChunkPayload& Payload : Payloads)
+	{
+		if (Payload.Data.IsEmpty()) continue;
+
+		Ar.Serialize(const_cast<uint8*>(Payload.Data.GetData()), Payload.Data.Num());
+	}
+
+	//Write next to the target and swap it in, so a crash never leaves a half written region
+	FString TempPath = Path + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(FileData, *TempPath)) return false;
+
+	return IFileManager::Get().Move(*Path, *TempPath, true, true);
+}
+
+FString FVoxelRegionStore::GetRegionPath(const FIntPoint& RegionCoord) const
+{
+	return Directory / FString::Printf(TEXT("r.%d.%d.vxr"), RegionCoord.X, RegionCoord.Y);
+}
+
+FIntPoint FVoxelRegionStore::GetRegionCoord(const FIntPoint& ChunkCoord)
+{
+	return FIntPoint(
+		FMath::FloorToInt32(ChunkCoord.X / float(RegionSize)),
+		FMath::FloorToInt32(ChunkCoord.Y / float(RegionSize))
+	);
+}
+
+int32 FVoxelRegionStore::GetRegionSlot(const FIntPoint& ChunkCoord)
+{
+	int32 X = ChunkCoord.X - GetRegionCoord(ChunkCoord).X * RegionSize;
+	int32 Y = ChunkCoord.Y - GetRegionCoord(ChunkCoord).Y * RegionSize;
+
+	return X + Y * RegionSize;
+}
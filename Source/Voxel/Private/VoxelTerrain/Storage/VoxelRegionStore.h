@@ -0,0 +1,103 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "../../Structs/VoxelBitset.h"
+
+struct FBlock;
+
+/**
+ * Saves and loads the blocks of chunks in region files.
+ * 
+ * A region file groups RegionSize x RegionSize chunks. It starts with a header and an
+   offset table with one entry per chunk, followed by the compressed blocks of every stored chunk.
+ * Regions are kept in memory once touched and written back by Flush, which replaces
+   the whole file atomically. Regions not touched since the previous flush are dropped
+   from memory once they are written. All functions are thread safe.
+ */
+class FVoxelRegionStore : public TSharedFromThis<FVoxelRegionStore>
+{
+public:
+	static constexpr int32 RegionSize = 32;
+
+	FVoxelRegionStore(const FString& InDirectory);
+
+	/**
+	 * Loads the blocks of a chunk. Returns false if the chunk was never saved
+	   or was saved with different chunk dimensions.
+	 * OutBorderSolid gets the border solidity saved with the chunk, or is reset when there is none.
+	 */
+	bool LoadChunk(const FIntPoint& ChunkCoord, int32 Width, int32 Height, TArray<FBlock>& OutBlocks, FVoxelBitset* OutBorderSolid = nullptr);
+
+	/**
+	 * Saves the blocks of a chunk, and optionally the solidity of the blocks around it.
+	 * The data is copied right away and compressed on a background thread, loads made
+	   in the meantime already see it.
+	 */
+	void SaveChunk(const FIntPoint& ChunkCoord, int32 Width, int32 Height, const TArray<FBlock>& Blocks, const FVoxelBitset* BorderSolid = nullptr);
+
+	/**
+	 * Writes every region changed since the last flush to disk, then drops the regions
+	   that were not used since the flush before.
+	 */
+	void Flush();
+
+	const FString& GetDirectory() const;
+
+private:
+	struct FChunkPayload
+	{
+		TArray<uint8> Data;
+		uint32 UncompressedSize = 0;
+	};
+
+	struct FRegion
+	{
+		//Compressed blocks of every chunk slot, empty if the chunk was never stored
+		TArray<FChunkPayload> Payloads;
+		bool bIsDirty = false;
+
+		//Value of FlushCount when the region was last used
+		uint32 LastUsedFlush = 0;
+	};
+
+	struct FPendingChunk
+	{
+		TArray<FBlock> Blocks;
+		FVoxelBitset BorderSolid;
+		int32 Width = 0;
+		int32 Height = 0;
+	};
+
+	FString Directory;
+
+	TMap<FIntPoint, TSharedPtr<FRegion>> Regions;
+
+	//Saved chunks that are not compressed yet
+	TMap<FIntPoint, TSharedPtr<FPendingChunk>> PendingChunks;
+
+	FCriticalSection RegionsLock;
+	FCriticalSection FlushLock;
+
+	uint32 FlushCount;
+
+	//Bumped whenever a region is dropped, so a read that raced with it is done again
+	uint32 EvictionCount;
+
+	/**
+	 * Compresses a pending chunk into its region slot.
+	 */
+	void CompressPendingChunk(const FIntPoint& ChunkCoord);
+
+	/**
+	 * Returns the region from memory, reading it from disk if it is not there.
+	 * Expects RegionsLock not to be held, the file is read without it.
+	 */
+	TSharedPtr<FRegion> FindOrLoadRegion(const FIntPoint& RegionCoord);
+
+	bool ReadRegionFile(const FString& Path, FRegion& OutRegion) const;
+	bool WriteRegionFile(const FString& Path, const TArray<FChunkPayload>& Payloads) const;
+
+	FString GetRegionPath(const FIntPoint& RegionCoord) const;
+	static FIntPoint GetRegionCoord(const FIntPoint& ChunkCoord);
+	static int32 GetRegionSlot(const FIntPoint& ChunkCoord);
+};
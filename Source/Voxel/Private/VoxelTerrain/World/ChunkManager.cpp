@@ -1,9 +1,22 @@
 
 #include "VoxelTerrain/World/ChunkManager.h"
 #include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
 #include "../Chunk/Chunk.h"
-#include "../../FastNoiseLite.h"
+#include "../Chunk/VoxelCollisionJob.h"
+#include "../Storage/VoxelRegionStore.h"
+#include "../Storage/VoxelBakedWorld.h"
+#include "../Generation/VoxelGenerator.h"
+#include "../Generation/VoxelNoiseTileCache.h"
+#include "../Lighting/VoxelLightEngine.h"
+#include "../Blocks/VoxelBlockRegistry.h"
+#include "../Blocks/VoxelBlockDataAsset.h"
 #include "../../Enums/BlockType.h"
+#include "../../Structs/Block.h"
+#include "../../Structs/VoxelChunkBuffer.h"
+#include "Misc/Paths.h"
+#include "Async/ParallelFor.h"
 
 AChunkManager::AChunkManager()
 {
@@ -11,40 +24,101 @@ AChunkManager::AChunkManager()
 	BlockSize = 100;
 	ChunkWidth = 32;
 	ChunkHeight = 32;
+	Seed = 1337;
 
 	MaxChunksPerTick = 8;
 	MaxMeshesPerTick = 8;
 	ChunkType = AChunk::StaticClass();
 
-	Noise = MakeShared<FastNoiseLite>();
-	Noise->SetFrequency(0.02f);
-	Noise->SetNoiseType(FastNoiseLite::NoiseType_Perlin);
-	Noise->SetFractalType(FastNoiseLite::FractalType_FBm);
-	Noise->SetFractalOctaves(3);
-	Noise->SetFractalLacunarity(2.0f);
-	Noise->SetFractalGain(0.3f); 
-	Noise->SetCellularJitter(0.25f);
-	Noise->SetCellularDistanceFunction(FastNoiseLite::CellularDistanceFunction_Euclidean);
-	Noise->SetCellularReturnType(FastNoiseLite::CellularReturnType_CellValue);
+	bSaveChunks = true;
+	WorldName = TEXT("Default");
+	SaveInterval = 10.0f;
+	TimeSinceSave = 0.0f;
+	NoiseCacheMegabytes = 64;
+	bCacheGeneratedChunks = true;
+	bSmoothLighting = true;
+	CollisionRadius = 1;
+	GenerationEpoch = 0;
+	RegenerationsInFlight = 0;
 }
 
 void AChunkManager::BeginPlay()
 {
 	Super::BeginPlay();
 
+	CreateGenerationSettings();
+
+	FVoxelNoiseTileCache::Get().SetMaxBytes(static_cast<int64>(NoiseCacheMegabytes) * 1024 * 1024);
+	FVoxelNoiseTileCache::Get().ResetStats();
+
 	int AmountOfChunks = DrawDistance * 2 * DrawDistance * 2;
 	for (int i = 0; i < AmountOfChunks; i++)
 	{
 		ChunkPool.Add(SpawnChunk(FVector(0, 0, 0)));
 	}
+
+	if (bSaveChunks)
+	{
+		RegionStore = MakeShared<FVoxelRegionStore>(FPaths::ProjectSavedDir() / TEXT("Worlds") / WorldName);
+	}
+
+	if (!BakedWorldFile.IsEmpty())
+	{
+		BakedWorld = FVoxelBakedWorld::Open(FPaths::ProjectDir() / BakedWorldFile);
+
+		if (!BakedWorld)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Could not open baked world %s, chunks will be generated"), *BakedWorldFile);
+		}
+		else if (BakedWorld->GetHeader().WorldHash != FVoxelGenerator::HashWorld(GenerationSettings->Seed, GenerationSettings->Params))
+		{
+			//Chunks of another seed or parameters would leave seams against generated ones
+			UE_LOG(LogTemp, Warning, TEXT("Baked world %s was made with a different seed or generator parameters, chunks will be generated"), *BakedWorldFile);
+			BakedWorld.Reset();
+		}
+	}
+}
+
+void AChunkManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (RegionStore)
+	{
+		for (auto& Pair : GeneratedChunks)
+		{
+			auto Chunk = Cast<IChunkable>(Pair.Value);
+			if (!Chunk) continue;
+
+			SaveChunk(Pair.Key, Chunk);
+		}
+
+		RegionStore->Flush();
+	}
+
+	if (GeneratedCache)
+	{
+		GeneratedCache->Flush();
+	}
+
+	FVoxelNoiseTileCacheStats CacheStats = FVoxelNoiseTileCache::Get().GetStats();
+	UE_LOG(LogTemp, Log, TEXT("Noise tile cache: %.1f%% hits, %llu evictions, %d tiles in %.1f MB"),
+		CacheStats.GetHitRate() * 100.0,
+		CacheStats.Evictions,
+		CacheStats.Tiles,
+		CacheStats.Bytes / (1024.0 * 1024.0)
+	);
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AChunkManager::Tick(float DeltaTime)
 {
 	AdjustGenerateRate();
 	RegenerateChunks();
-	ProcessChunkGeneration();
+	int32 ChunksStarted = ProcessChunkGeneration();
+	ProcessRegeneration(MaxChunksPerTick - ChunksStarted);
 	ProcessMeshGeneration();
+	UpdateCollision();
+	TickSave(DeltaTime);
 }
 
 void AChunkManager::RegenerateChunks()
@@ -68,6 +142,9 @@ void AChunkManager::ProcessMeshGeneration()
 		{
 			MeshQueueLength--;
 
+			//Neighbours are only safe to read on the game thread, so their light is copied before the job starts
+			Chunk->CaptureBorderLight();
+
 			AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [this, Chunk]()
 			{
 				Chunk->CreateChunkMesh(true);
@@ -83,7 +160,60 @@ void AChunkManager::ProcessMeshGeneration()
 	}
 }
 
-void AChunkManager::ProcessChunkGeneration()
+void AChunkManager::UpdateCollision()
+{
+	TArray<FIntPoint> PlayerCoords;
+	GetPlayerChunkCoords(PlayerCoords);
+
+	int32 CollisionsStarted = 0;
+
+	for (auto& Pair : GeneratedChunks)
+	{
+		auto Chunk = Cast<IChunkable>(Pair.Value);
+		if (!Chunk) continue;
+
+		FIntPoint ChunkCoord = GetChunkCoord(Pair.Key);
+		bool bIsNearPlayer = false;
+
+		for (const FIntPoint& PlayerCoord : PlayerCoords)
+		{
+			FIntPoint Distance = ChunkCoord - PlayerCoord;
+			bIsNearPlayer |= FMath::Max(FMath::Abs(Distance.X), FMath::Abs(Distance.Y)) <= CollisionRadius;
+		}
+
+		if (!bIsNearPlayer)
+		{
+			Chunk->SetCollisionEnabled(false);
+			continue;
+		}
+
+		Chunk->SetCollisionEnabled(true);
+
+		//Chunks still being generated are built once their mesh is shown
+		if (!Chunk->IsMeshed() || CollisionsStarted >= MaxMeshesPerTick) continue;
+
+		TSharedPtr<FVoxelCollisionJob> Job = Chunk->StartCollisionBuild();
+		if (!Job) continue;
+
+		CollisionsStarted++;
+		TWeakObjectPtr<AActor> ChunkActor = Pair.Value.Get();
+
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [ChunkActor, Job]()
+		{
+			Job->Build();
+
+			AsyncTask(ENamedThreads::GameThread, [ChunkActor, Job]()
+			{
+				auto Chunk = Cast<IChunkable>(ChunkActor.Get());
+				if (!Chunk) return;
+
+				Chunk->FinishCollisionBuild(*Job);
+			});
+		});
+	}
+}
+
+int32 AChunkManager::ProcessChunkGeneration()
 {
 	int32 ChunksProcessed = 0;
 
@@ -102,9 +232,11 @@ void AChunkManager::ProcessChunkGeneration()
 			auto Chunk = Cast<IChunkable>(ChunkActor);
 			if (!Chunk) continue;
 
-			AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [this, Chunk]()
+			FIntPoint ChunkCoord = GetChunkCoord(ChunkPos);
+
+			AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [this, Chunk, ChunkCoord, Settings = GenerationSettings, Store = RegionStore, Baked = BakedWorld, Cache = GeneratedCache]()
 			{
-				Chunk->GenerateChunk(Noise);
+				LoadOrGenerateChunk(Chunk, ChunkCoord, Settings, Store, Baked, Cache);
 
 				AsyncTask(ENamedThreads::GameThread, [this, Chunk]()
 				{
@@ -113,10 +245,374 @@ void AChunkManager::ProcessChunkGeneration()
 			});
 
 			GeneratedChunks.Add(ChunkPos, ChunkActor);
+			ChunkEpochs.Add(ChunkPos, GenerationEpoch);
 
 			ChunksProcessed++;
 		}
 	}
+
+	return ChunksProcessed;
+}
+
+void AChunkManager::ProcessRegeneration(int32 Budget)
+{
+	TArray<FVector> Deferred;
+
+	while (Budget > 0 && !RegenerationQueue.IsEmpty() && RegenerationsInFlight < MaxChunksPerTick)
+	{
+		FVector ChunkPos = RegenerationQueue.Pop();
+
+		TObjectPtr<AActor>* OldActor = GeneratedChunks.Find(ChunkPos);
+		if (!OldActor || !*OldActor) continue;
+
+		uint32* ChunkEpoch = ChunkEpochs.Find(ChunkPos);
+		if (ChunkEpoch && *ChunkEpoch == GenerationEpoch) continue;
+
+		auto OldChunk = Cast<IChunkable>(OldActor->Get());
+		if (!OldChunk) continue;
+
+		//Edited chunks load their saved blocks, which do not depend on the parameters
+		if (OldChunk->IsModified())
+		{
+			ChunkEpochs.Add(ChunkPos, GenerationEpoch);
+			continue;
+		}
+
+		//Its first generation job still writes into the chunk, so it keeps its old epoch and is tried again later
+		if (!OldChunk->IsMeshed())
+		{
+			Deferred.Add(ChunkPos);
+			continue;
+		}
+
+		TObjectPtr<AActor> StagingActor = ChunkPool.IsEmpty() ? SpawnChunk(ChunkPos) : ChunkPool.Pop();
+		auto Staging = Cast<IChunkable>(StagingActor);
+		if (!Staging) continue;
+
+		StagingActor->SetActorLocation(ChunkPos);
+		Staging->CaptureBorderLight();
+		//The new chunk brings its own collision, so players do not fall through when it is swapped in
+		Staging->SetCollisionEnabled(OldChunk->IsCollisionEnabled());
+		ChunkEpochs.Add(ChunkPos, GenerationEpoch);
+		RegenerationsInFlight++;
+		Budget--;
+
+		FIntPoint ChunkCoord = GetChunkCoord(ChunkPos);
+		//Actors may be gone by the time the job finishes, e.g. when play ends
+		TWeakObjectPtr<AActor> Old = OldActor->Get();
+		TWeakObjectPtr<AActor> New = StagingActor.Get();
+		uint32 Epoch = GenerationEpoch;
+
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [this, Staging, ChunkCoord, ChunkPos, Old, New, Epoch, Settings = GenerationSettings, Store = RegionStore, Baked = BakedWorld, Cache = GeneratedCache]()
+		{
+			LoadOrGenerateChunk(Staging, ChunkCoord, Settings, Store, Baked, Cache);
+			Staging->CreateChunkMesh(true);
+
+			//Nothing else touches the staging chunk until it is swapped in, so its collision is built right here
+			TSharedPtr<FVoxelCollisionJob> CollisionJob = Staging->StartCollisionBuild();
+			if (CollisionJob)
+				CollisionJob->Build();
+
+			AsyncTask(ENamedThreads::GameThread, [this, ChunkPos, Old, New, Epoch, CollisionJob]()
+			{
+				FinishRegeneration(ChunkPos, New, Old, Epoch, CollisionJob);
+			});
+		});
+	}
+
+	//Front of the queue, so the waiting chunks do not hold back the ones that are ready
+	RegenerationQueue.Insert(Deferred, 0);
+}
+
+void AChunkManager::FinishRegeneration(
+	const FVector& ChunkPos,
+	const TWeakObjectPtr<AActor>& StagingActor,
+	const TWeakObjectPtr<AActor>& OldActor,
+	uint32 Epoch,
+	const TSharedPtr<FVoxelCollisionJob>& CollisionJob
+)
+{
+	RegenerationsInFlight--;
+
+	AActor* StagingChunkActor = StagingActor.Get();
+	auto Staging = Cast<IChunkable>(StagingChunkActor);
+	if (!Staging) return;
+
+	AActor* OldChunkActor = OldActor.Get();
+	auto OldChunk = Cast<IChunkable>(OldChunkActor);
+	TObjectPtr<AActor>* Current = GeneratedChunks.Find(ChunkPos);
+
+	bool bIsStale = !OldChunk || !Current || Current->Get() != OldChunkActor || Epoch != GenerationEpoch || OldChunk->IsModified();
+	if (bIsStale)
+	{
+		Staging->ClearChunk();
+		ChunkPool.Add(StagingChunkActor);
+		return;
+	}
+
+	//Swap in the same frame, so the terrain never shows a hole
+	Staging->ApplyMesh();
+	if (CollisionJob)
+		Staging->FinishCollisionBuild(*CollisionJob);
+	*Current = StagingChunkActor;
+
+	OldChunk->ClearChunk();
+	ChunkPool.Add(OldChunkActor);
+}
+
+bool AChunkManager::VoxelRaycast(const FVector& Start, const FVector& End, FVoxelRaycastHit& OutHit) const
+{
+	return TraceBlocks(Start, End, false, OutHit);
+}
+
+void AChunkManager::VoxelLineOfSight(const TArray<FVector>& Starts, const TArray<FVector>& Ends, TArray<bool>& OutVisible) const
+{
+	int32 NumLines = FMath::Min(Starts.Num(), Ends.Num());
+	OutVisible.SetNumUninitialized(NumLines);
+
+	ParallelFor(NumLines, [this, &Starts, &Ends, &OutVisible](int32 Index)
+	{
+		FVoxelRaycastHit Hit;
+		OutVisible[Index] = !TraceBlocks(Starts[Index], Ends[Index], true, Hit);
+	});
+}
+
+bool AChunkManager::TraceBlocks(const FVector& Start, const FVector& End, bool bOpaqueOnly, FVoxelRaycastHit& OutHit) const
+{
+	if (!GenerationSettings) return false;
+
+	const FVoxelBlockRegistry& Registry = *GenerationSettings->Blocks;
+
+	//In grid space every block spans one unit and its local position is the floor of the point
+	FVector GridOffset = FVector(0.5, 0.5, -0.5);
+	FVector GridStart = Start / BlockSize + GridOffset;
+	FVector Delta = End / BlockSize + GridOffset - GridStart;
+	double Length = Delta.Size();
+	FVector Direction = Length > UE_KINDA_SMALL_NUMBER ? Delta / Length : FVector::ZeroVector;
+
+	FIntVector Cell = FIntVector(
+		FMath::FloorToInt32(GridStart.X),
+		FMath::FloorToInt32(GridStart.Y),
+		FMath::FloorToInt32(GridStart.Z)
+	);
+	FIntVector Step;
+	FVector NextBoundary;
+	FVector BoundaryStep;
+
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		Step[Axis] = Direction[Axis] > 0 ? 1 : (Direction[Axis] < 0 ? -1 : 0);
+
+		if (Step[Axis] == 0)
+		{
+			NextBoundary[Axis] = TNumericLimits<double>::Max();
+			BoundaryStep[Axis] = TNumericLimits<double>::Max();
+			continue;
+		}
+
+		BoundaryStep[Axis] = FMath::Abs(1.0 / Direction[Axis]);
+		double ToBoundary = Step[Axis] > 0 ? Cell[Axis] + 1 - GridStart[Axis] : GridStart[Axis] - Cell[Axis];
+		NextBoundary[Axis] = ToBoundary * BoundaryStep[Axis];
+	}
+
+	//Remembers the chunk of the last block, lines rarely leave it
+	FIntPoint ChunkCoord = FIntPoint(MAX_int32, MAX_int32);
+	const TArray<FBlock>* ChunkBlocks = nullptr;
+	double Distance = 0;
+	int32 EnteredAxis = INDEX_NONE;
+
+	while (Distance <= Length)
+	{
+		//Nothing is above or below the chunks, once there the line never comes back
+		if ((Cell.Z < 0 && Step.Z <= 0) || (Cell.Z >= ChunkHeight && Step.Z >= 0))
+			return false;
+
+		if (Cell.Z >= 0 && Cell.Z < ChunkHeight)
+		{
+			FIntPoint CellChunk = FIntPoint(
+				FMath::FloorToInt32(static_cast<float>(Cell.X) / ChunkWidth),
+				FMath::FloorToInt32(static_cast<float>(Cell.Y) / ChunkWidth)
+			);
+
+			if (CellChunk != ChunkCoord)
+			{
+				ChunkCoord = CellChunk;
+				ChunkBlocks = FindChunkBlocks(ChunkCoord);
+			}
+
+			if (ChunkBlocks)
+			{
+				int32 LocalX = Cell.X - ChunkCoord.X * ChunkWidth;
+				int32 LocalY = Cell.Y - ChunkCoord.Y * ChunkWidth;
+				EBlockType Type = (*ChunkBlocks)[Cell.Z + ChunkHeight * (LocalX + ChunkWidth * LocalY)].Type;
+
+				bool bIsHit = bOpaqueOnly ? Registry.IsOpaque(Type) : Registry.IsSolid(Type);
+				if (bIsHit)
+				{
+					OutHit.BlockLocation = FVector(Cell.X, Cell.Y, Cell.Z + 1) * BlockSize;
+					OutHit.Normal = FVector::ZeroVector;
+					if (EnteredAxis != INDEX_NONE)
+						OutHit.Normal[EnteredAxis] = -Step[EnteredAxis];
+					OutHit.Distance = Distance * BlockSize;
+					OutHit.BlockType = Type;
+					return true;
+				}
+			}
+		}
+
+		if (Length <= UE_KINDA_SMALL_NUMBER)
+			return false;
+
+		EnteredAxis = NextBoundary.X < NextBoundary.Y ?
+			(NextBoundary.X < NextBoundary.Z ? 0 : 2) :
+			(NextBoundary.Y < NextBoundary.Z ? 1 : 2);
+
+		Distance = NextBoundary[EnteredAxis];
+		NextBoundary[EnteredAxis] += BoundaryStep[EnteredAxis];
+		Cell[EnteredAxis] += Step[EnteredAxis];
+	}
+
+	return false;
+}
+
+const TArray<FBlock>* AChunkManager::FindChunkBlocks(const FIntPoint& ChunkCoord) const
+{
+	float ChunkSize = BlockSize * ChunkWidth;
+
+	auto ChunkActor = GeneratedChunks.Find(FVector(ChunkCoord.X * ChunkSize, ChunkCoord.Y * ChunkSize, 0));
+	if (!ChunkActor) return nullptr;
+
+	//Chunks that were not meshed yet may still be filled by their generation job
+	auto Chunk = Cast<IChunkable>(*ChunkActor);
+	if (!Chunk || !Chunk->IsMeshed()) return nullptr;
+
+	const TArray<FBlock>& Blocks = Chunk->GetBlocks();
+	if (Blocks.Num() != ChunkWidth * ChunkWidth * ChunkHeight) return nullptr;
+
+	return &Blocks;
+}
+
+void AChunkManager::GetBorderLight(const FIntPoint& ChunkCoord, TArray<uint8>& OutLight) const
+{
+	static const FIntPoint SideOffsets[FVoxelChunkBuffer::NumBorderSides] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+
+	OutLight.SetNumUninitialized(FVoxelChunkBuffer::NumBorderSides * ChunkWidth * ChunkHeight);
+
+	for (int32 Side = 0; Side < FVoxelChunkBuffer::NumBorderSides; Side++)
+	{
+		const TArray<FBlock>* Neighbor = FindChunkBlocks(ChunkCoord + SideOffsets[Side]);
+
+		for (int32 Along = 0; Along < ChunkWidth; Along++)
+		{
+			FIntPoint Column = FVoxelChunkBuffer::GetBorderColumn(Side, Along, ChunkWidth);
+			uint8* Light = &OutLight[FVoxelChunkBuffer::GetBorderIndex(Side, Along, 0, ChunkWidth, ChunkHeight)];
+
+			if (Neighbor)
+			{
+				//The same column seen from the neighbour, wrapped into its local coordinates
+				int32 LocalX = (Column.X + ChunkWidth) % ChunkWidth;
+				int32 LocalY = (Column.Y + ChunkWidth) % ChunkWidth;
+				const FBlock* NeighborColumn = &(*Neighbor)[ChunkHeight * (LocalX + ChunkWidth * LocalY)];
+
+				for (int32 Z = 0; Z < ChunkHeight; Z++)
+				{
+					Light[Z] = NeighborColumn[Z].Light;
+				}
+				continue;
+			}
+
+			int32 ColumnHeight = FVoxelGenerator::GetColumnHeight(*GenerationSettings, ChunkCoord * ChunkWidth + Column);
+			for (int32 Z = 0; Z < ChunkHeight; Z++)
+			{
+				Light[Z] = Z + 1 >= ColumnHeight ? FBlock::MaxLight << 4 : 0;
+			}
+		}
+	}
+}
+
+void AChunkManager::SetGeneratorParams(const FVoxelGeneratorParams& NewParams)
+{
+	GeneratorParams = NewParams;
+	ApplyGeneratorParams();
+}
+
+#if WITH_EDITOR
+void AChunkManager::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	FName MemberName = PropertyChangedEvent.GetMemberPropertyName();
+	bool bIsGenerationProperty =
+		MemberName == GET_MEMBER_NAME_CHECKED(AChunkManager, GeneratorParams) ||
+		MemberName == GET_MEMBER_NAME_CHECKED(AChunkManager, Seed) ||
+		MemberName == GET_MEMBER_NAME_CHECKED(AChunkManager, BlockData);
+
+	if (!bIsGenerationProperty) return;
+
+	ApplyGeneratorParams();
+}
+#endif
+
+void AChunkManager::CreateGenerationSettings()
+{
+	FVoxelGeneratorParams Params = GeneratorParams;
+	Params.BlockSize = BlockSize;
+	Params.ChunkWidth = ChunkWidth;
+	Params.ChunkHeight = ChunkHeight;
+	TSharedRef<const FVoxelBlockRegistry> Blocks = BlockData ?
+		MakeShared<FVoxelBlockRegistry>(*BlockData) :
+		MakeShared<FVoxelBlockRegistry>();
+
+	GenerationSettings = MakeShared<FVoxelGenerationSettings>(Seed, Params, Blocks);
+
+	if (GeneratedCache)
+	{
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Cache = GeneratedCache]()
+		{
+			Cache->Flush();
+		});
+
+		GeneratedCache.Reset();
+	}
+
+	if (bCacheGeneratedChunks)
+	{
+		FString WorldHash = FString::Printf(TEXT("%016llx"), FVoxelGenerator::HashWorld(Seed, Params));
+		GeneratedCache = MakeShared<FVoxelRegionStore>(FPaths::ProjectSavedDir() / TEXT("VoxelCache") / WorldHash);
+	}
+}
+
+void AChunkManager::ApplyGeneratorParams()
+{
+	//Only the running world regenerates, the settings are built in BeginPlay otherwise
+	if (!HasActorBegunPlay()) return;
+
+	CreateGenerationSettings();
+	GenerationEpoch++;
+
+	//The baked world holds blocks of the parameters it was baked with
+	if (BakedWorld)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Generator parameters changed, no longer loading chunks from the baked world"));
+		BakedWorld.Reset();
+	}
+
+	RegenerationQueue.Reset();
+	for (auto& Pair : GeneratedChunks)
+	{
+		if (!Pair.Value) continue;
+
+		RegenerationQueue.Add(Pair.Key);
+	}
+
+	//Farthest first in the array, so popping from the end gives the nearest chunk
+	FVector Center = GetPlayerLocation();
+	Center.Z = 0;
+
+	RegenerationQueue.Sort([&Center](const FVector& A, const FVector& B)
+	{
+		return FVector::DistSquared(A, Center) > FVector::DistSquared(B, Center);
+	});
 }
 
 void AChunkManager::EnqueueChunks(const TArray<FVector>& ChunkPositions)
@@ -144,10 +640,12 @@ void AChunkManager::EnqueueChunks(const TArray<FVector>& ChunkPositions)
 				
 			ChunkPool.Add(*ChunkActor);
 			GeneratedChunks.Remove(ChunkLoc);
+			ChunkEpochs.Remove(ChunkLoc);
 
 			auto Chunk = Cast<IChunkable>(ChunkActor->Get());
 			if (!Chunk) continue;
 			
+			SaveChunk(ChunkLoc, Chunk);
 			Chunk->ClearChunk();
 		}
 	}
@@ -211,7 +709,83 @@ void AChunkManager::AdjustGenerateRate()
 	}
 }
 
-bool AChunkManager::IsBlockAir(const FVector& ChunkLocation, const FVector& BlockLocation) const
+void AChunkManager::LoadOrGenerateChunk(
+	IChunkable* Chunk,
+	const FIntPoint& ChunkCoord,
+	const TSharedPtr<const FVoxelGenerationSettings>& Settings,
+	const TSharedPtr<FVoxelRegionStore>& Store,
+	const TSharedPtr<FVoxelBakedWorld>& Baked,
+	const TSharedPtr<FVoxelRegionStore>& Cache
+)
+{
+	TArray<FBlock> StoredBlocks;
+	FVoxelBitset StoredBorder;
+
+	//Saved chunks carry edits, so they win over the baked world
+	if (Store && Store->LoadChunk(ChunkCoord, ChunkWidth, ChunkHeight, StoredBlocks, &StoredBorder))
+	{
+		Chunk->LoadChunk(Settings, MoveTemp(StoredBlocks), MoveTemp(StoredBorder));
+		return;
+	}
+
+	if (Baked && Baked->LoadChunk(ChunkCoord, ChunkWidth, ChunkHeight, StoredBlocks, &StoredBorder))
+	{
+		Chunk->LoadChunk(Settings, MoveTemp(StoredBlocks), MoveTemp(StoredBorder));
+		return;
+	}
+
+	if (Cache && Cache->LoadChunk(ChunkCoord, ChunkWidth, ChunkHeight, StoredBlocks, &StoredBorder))
+	{
+		Chunk->LoadChunk(Settings, MoveTemp(StoredBlocks), MoveTemp(StoredBorder));
+		return;
+	}
+
+	Chunk->GenerateChunk(Settings);
+
+	if (Cache)
+	{
+		Cache->SaveChunk(ChunkCoord, ChunkWidth, ChunkHeight, Chunk->GetBlocks(), &Chunk->GetBorderSolid());
+	}
+}
+
+void AChunkManager::SaveChunk(const FVector& ChunkLocation, IChunkable* Chunk)
+{
+	if (!RegionStore) return;
+	if (Chunk->GetBlocks().IsEmpty()) return;
+
+	//Unedited chunks are either stored already or can be loaded or generated again
+	if (!Chunk->IsModified()) return;
+
+	RegionStore->SaveChunk(GetChunkCoord(ChunkLocation), ChunkWidth, ChunkHeight, Chunk->GetBlocks(), &Chunk->GetBorderSolid());
+}
+
+void AChunkManager::TickSave(float DeltaTime)
+{
+	if (!RegionStore && !GeneratedCache) return;
+
+	TimeSinceSave += DeltaTime;
+	if (TimeSinceSave < SaveInterval) return;
+
+	TimeSinceSave = 0.0f;
+
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Store = RegionStore, Cache = GeneratedCache]()
+	{
+		if (Store) Store->Flush();
+		if (Cache) Cache->Flush();
+	});
+}
+
+FIntPoint AChunkManager::GetChunkCoord(const FVector& ChunkLocation) const
+{
+	float ChunkSize = BlockSize * ChunkWidth;
+
+	return FIntPoint(
+		FMath::RoundToInt32(ChunkLocation.X / ChunkSize),
+		FMath::RoundToInt32(ChunkLocation.Y / ChunkSize)
+	);
+}
+
+bool AChunkManager::IsFaceVisible(const FVector& ChunkLocation, const FVector& BlockLocation, EBlockType FaceType) const
 {
 	auto ChunkActor = GeneratedChunks.Find(ChunkLocation.GridSnap(BlockSize * DrawDistance));
 	if (!ChunkActor) return false;
@@ -219,23 +793,61 @@ bool AChunkManager::IsBlockAir(const FVector& ChunkLocation, const FVector& Bloc
 	auto Chunk = Cast<IChunkable>(*ChunkActor);
 	if (!Chunk) return false;
 
-	auto Block = Chunk->GetBlocks().Find(BlockLocation.GridSnap(BlockSize));
+	auto Block = Chunk->GetBlock(BlockLocation.GridSnap(BlockSize));
 	if (!Block) return false;
 
-	return Block->Type == EBlockType::Air;
+	return GenerationSettings->Blocks->IsFaceVisible(FaceType, Block->Type);
 }
 
-void AChunkManager::AddPotentialBlockAndRebuild(const FVector& ChunkLocation, const FVector& BlockPosition)
+IChunkable* AChunkManager::AddPotentialBlock(const FVector& ChunkLocation, const FVector& BlockPosition)
 {
 	auto ChunkActor = GeneratedChunks.Find(ChunkLocation.GridSnap(BlockSize * DrawDistance));
-	if (!ChunkActor) return;
+	if (!ChunkActor) return nullptr;
 
+	//Chunks still being generated find their surface blocks themselves
 	auto Chunk = Cast<IChunkable>(*ChunkActor);
-	if (!Chunk) return;
+	if (!Chunk || !Chunk->IsMeshed()) return nullptr;
 
 	Chunk->AddPotentialBlock(BlockPosition);
-	Chunk->CreateChunkMesh(false);
-	Chunk->ApplyMesh();
+
+	return Chunk;
+}
+
+void AChunkManager::UpdateLightAround(const FVector& ChunkLocation, const FIntVector& Local, TSet<IChunkable*>& OutChanged)
+{
+	float ChunkSize = BlockSize * ChunkWidth;
+	FVoxelLightNeighborhood Neighborhood(*GenerationSettings->Blocks, ChunkWidth, ChunkHeight);
+	IChunkable* Chunks[FVoxelLightNeighborhood::NumChunks] = {};
+
+	for (int32 Y = -1; Y <= 1; Y++)
+	{
+		for (int32 X = -1; X <= 1; X++)
+		{
+			auto ChunkActor = GeneratedChunks.Find((ChunkLocation + FVector(X, Y, 0) * ChunkSize).GridSnap(ChunkSize));
+			if (!ChunkActor) continue;
+
+			auto Chunk = Cast<IChunkable>(*ChunkActor);
+			if (!Chunk) continue;
+
+			//Neighbours still being generated are written by their job, they get their light when it finishes
+			bool bIsCenter = X == 0 && Y == 0;
+			if (!bIsCenter && !Chunk->IsMeshed()) continue;
+
+			int32 Slot = FVoxelLightNeighborhood::GetSlot(X, Y);
+			Chunks[Slot] = Chunk;
+			Neighborhood.Chunks[Slot] = &Chunk->GetMutableBlocks();
+		}
+	}
+
+	FVoxelLightEngine::UpdateLight(Neighborhood, Local);
+
+	int32 CenterSlot = FVoxelLightNeighborhood::GetSlot(0, 0);
+	for (int32 Slot = 0; Slot < FVoxelLightNeighborhood::NumChunks; Slot++)
+	{
+		if (Slot == CenterSlot || !Chunks[Slot] || !Neighborhood.IsChanged(Slot)) continue;
+
+		OutChanged.Add(Chunks[Slot]);
+	}
 }
 
 void AChunkManager::AddBlock(const FVector& Position, const EBlockType& NewType)
@@ -244,7 +856,7 @@ void AChunkManager::AddBlock(const FVector& Position, const EBlockType& NewType)
 	{
 		auto Chunk = Cast<IChunkable>(Pair.Value);
 		if (!Chunk) continue;
-		if (!Chunk->GetBlocks().Find(Position.GridSnap(BlockSize))) continue;
+		if (!Chunk->GetBlock(Position.GridSnap(BlockSize))) continue;
 
 		Chunk->ModifyBlock(Position, NewType);
 		return;
@@ -257,7 +869,7 @@ void AChunkManager::RemoveBlock(const FVector& Position)
 	{
 		auto Chunk = Cast<IChunkable>(Pair.Value);
 		if (!Chunk) continue;
-		if (!Chunk->GetBlocks().Find(Position.GridSnap(BlockSize))) continue;
+		if (!Chunk->GetBlock(Position.GridSnap(BlockSize))) continue;
 
 		Chunk->ModifyBlock(Position, EBlockType::Air);
 		return;
@@ -324,4 +936,28 @@ FVector AChunkManager::GetPlayerLocation() const
 	FRotator CameraRotation;
 	PlayerController->GetPlayerViewPoint(CameraLocation, CameraRotation);
 	return CameraLocation.GridSnap(BlockSize * ChunkWidth);
+}
+
+void AChunkManager::GetPlayerChunkCoords(TArray<FIntPoint>& OutCoords) const
+{
+	UWorld* World = GetWorld();
+	if (!World) return;
+
+	float ChunkSize = BlockSize * ChunkWidth;
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		if (!PlayerController) continue;
+
+		APawn* Pawn = PlayerController->GetPawn();
+		if (!Pawn) continue;
+
+		//Blocks are centered on the grid, so a chunk starts half a block before its location
+		FVector Location = Pawn->GetActorLocation() + FVector(BlockSize / 2.0f);
+		OutCoords.Add(FIntPoint(
+			FMath::FloorToInt32(Location.X / ChunkSize),
+			FMath::FloorToInt32(Location.Y / ChunkSize)
+		));
+	}
 }
\ No newline at end of file
@@ -2,12 +2,18 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "../../Structs/VoxelGeneratorParams.h"
+#include "../../Structs/VoxelRaycastHit.h"
 #include "ChunkManager.generated.h"
 
-class FastNoiseLite;
+struct FVoxelGenerationSettings;
 class AChunk;
 enum class EBlockType : uint8;
 class IChunkable;
+class FVoxelRegionStore;
+class FVoxelBakedWorld;
+class UVoxelBlockDataAsset;
+struct FVoxelCollisionJob;
 struct FBlock;
 
 /**
@@ -42,18 +48,36 @@ public:
 
 	/**
 	 * How wide should a chunk be.
-	 * Wider chunks will take longer to draw and generate.
+	 * Wider chunks will take longer to draw and generate. Limited by FVoxelQuad::MaxWidth.
 	 */
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "ChunkManager")
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "ChunkManager", meta = (ClampMin = "1", ClampMax = "1024"))
 	int32 ChunkWidth;
 
 	/**
 	 * How tall should a chunk be.
-	 * Taller chunks will take longer to draw and generate.
+	 * Taller chunks will take longer to draw and generate. Limited by FVoxelQuad::MaxHeight.
 	 */
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "ChunkManager")
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "ChunkManager", meta = (ClampMin = "1", ClampMax = "512"))
 	int32 ChunkHeight;
 
+	/**
+	 * Seed of the terrain noise.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "ChunkManager")
+	int32 Seed;
+
+	/**
+	 * Terrain generator settings. Block size and chunk dimensions are taken from this actor.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "ChunkManager")
+	FVoxelGeneratorParams GeneratorParams;
+
+	/**
+	 * Block types of the world. Built-in block types are used when not set.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ChunkManager")
+	TObjectPtr<UVoxelBlockDataAsset> BlockData;
+
 	/**
 	 * Chunk type to spawn.
 	 * Actor Chunk should implement interface IChunkable
@@ -61,6 +85,60 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ChunkManager")
 	TSubclassOf<AActor> ChunkType;
 
+	/**
+	 * Whether edited chunks leaving the draw distance are saved to region files,
+	   so edits survive the chunk being unloaded and the session ending.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ChunkManager")
+	bool bSaveChunks;
+
+	/**
+	 * Name of the folder in Saved/Worlds the region files are written to.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ChunkManager")
+	FString WorldName;
+
+	/**
+	 * How often in seconds changed regions are written to disk.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ChunkManager")
+	float SaveInterval;
+
+	/**
+	 * Pre-generated world file, relative to the project folder.
+	 * Chunks inside the baked world are loaded from it instead of being generated.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ChunkManager")
+	FString BakedWorldFile;
+
+	/**
+	 * Keeps generated chunks on disk, keyed by the seed, the generator parameters and version,
+	   so later sessions load them instead of generating them again.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ChunkManager")
+	bool bCacheGeneratedChunks;
+
+	/**
+	 * Memory cap of the noise tile cache shared by all generation jobs, in megabytes.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ChunkManager")
+	int32 NoiseCacheMegabytes;
+
+	/**
+	 * Whether mesh vertices average the light of the blocks around them, instead of every
+	   face being lit evenly. Adds 4 bytes per face and a few block lookups per corner while meshing.
+	 * Read by chunks when they are spawned.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ChunkManager")
+	bool bSmoothLighting;
+
+	/**
+	 * How far from a player chunks have collision, in chunks.
+	 * Chunks further away have none, so only the few around players are cooked for physics.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ChunkManager")
+	int32 CollisionRadius;
+
 	/**
 	 * Generates chunks within the defined draw distance around the player.
 	 *
@@ -83,17 +161,58 @@ public:
 	void RemoveBlock(const FVector& Position);
 
 	/**
-	 * Adds a potential block that might have faces to the chunk and rebuilds chunk mesh.
+	 * Walks the blocks between Start and End and returns the first solid one that was hit.
+	 * Reads the loaded chunks directly, so it works without collision. Unloaded chunks are passed through.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ChunkManager")
+	bool VoxelRaycast(const FVector& Start, const FVector& End, FVoxelRaycastHit& OutHit) const;
+
+	/**
+	 * Checks many lines at once, in parallel, for whether an opaque block is in the way.
+	 * OutVisible holds one entry per pair of Starts and Ends, true if nothing blocks the line.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ChunkManager")
+	void VoxelLineOfSight(const TArray<FVector>& Starts, const TArray<FVector>& Ends, TArray<bool>& OutVisible) const;
+
+	/**
+	 * Replaces the generator parameters while playing.
+	 * Loaded chunks are generated again nearest first, within the per tick budget,
+	   and keep showing their current mesh until the new one is ready.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ChunkManager")
+	void SetGeneratorParams(const FVoxelGeneratorParams& NewParams);
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/**
+	 * Adds a potential block that might have faces to the chunk. Does not rebuild the chunk mesh.
+	 * Returns the chunk, or nullptr if it is not loaded or not meshed yet.
+	 */
+	IChunkable* AddPotentialBlock(const FVector& ChunkLocation, const FVector& BlockPosition);
+
+	/**
+	 * Updates light after the type of a block changed, in the chunk at ChunkLocation and the
+	   chunks around it. Neighbouring chunks whose light changed are added to OutChanged, to be rebuilt by the caller.
+	 * Neighbours that were not meshed yet are still being generated and are left out.
 	 */
-	void AddPotentialBlockAndRebuild(const FVector& ChunkLocation, const FVector& BlockPosition);
+	void UpdateLightAround(const FVector& ChunkLocation, const FIntVector& Local, TSet<IChunkable*>& OutChanged);
 
 	/**
-	 * Checks if given BlockLocation exists in given Chunk.
+	 * Light of the blocks right outside the four sides of a chunk, laid out like FVoxelChunkBuffer::BorderSolid.
+	 * Sides towards neighbours that are not meshed yet are estimated from the height noise,
+	   open sky above the surface and dark below it.
 	 */
-	bool IsBlockAir(const FVector& ChunkLocation, const FVector& BlockLocation) const;
+	void GetBorderLight(const FIntPoint& ChunkCoord, TArray<uint8>& OutLight) const;
+
+	/**
+	 * Checks if a face of a block of FaceType is seen next to BlockLocation in given Chunk.
+	 */
+	bool IsFaceVisible(const FVector& ChunkLocation, const FVector& BlockLocation, EBlockType FaceType) const;
 
 protected:
-	TSharedPtr<FastNoiseLite> Noise;
+	TSharedPtr<const FVoxelGenerationSettings> GenerationSettings;
 	TMap<FVector, TObjectPtr<AActor>> GeneratedChunks;
 
 	uint8 MaxChunksPerTick;
@@ -106,16 +225,114 @@ protected:
 
 	TArray<TObjectPtr<AActor>> ChunkPool;
 
+	TSharedPtr<FVoxelRegionStore> RegionStore;
+	TSharedPtr<FVoxelBakedWorld> BakedWorld;
+
+	//Generated chunks of the current seed and parameters, in a folder named by their hash
+	TSharedPtr<FVoxelRegionStore> GeneratedCache;
+
+	//Bumped every time the generation settings change
+	uint32 GenerationEpoch;
+
+	//Epoch the blocks of every loaded chunk were generated with
+	TMap<FVector, uint32> ChunkEpochs;
+
+	//Loaded chunks to generate again, the nearest one last
+	TArray<FVector> RegenerationQueue;
+	int32 RegenerationsInFlight;
+
+	float TimeSinceSave;
+
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaTime) override;
 	
 	void ProcessMeshGeneration();
-	void ProcessChunkGeneration();
+
+	/**
+	 * Turns collision on for chunks within CollisionRadius of a player and off for the rest.
+	 * Chunks that already have a mesh build their collision on a background thread, one job per chunk at a time.
+	 */
+	void UpdateCollision();
+
+	/**
+	 * Starts generating queued chunks, returns how many were started.
+	 */
+	int32 ProcessChunkGeneration();
 	void EnqueueChunks(const TArray<FVector>& ChunkPositions);
 	void EnqueueMesh(IChunkable* Chunk);
 
 	void AdjustGenerateRate();
 
+	/**
+	 * Fills a chunk from saved, baked or cached blocks if there are any, otherwise generates
+	   it and adds it to the generated chunk cache.
+	 * Runs on a background thread, so the settings and stores are the ones captured when the job was queued.
+	 */
+	void LoadOrGenerateChunk(
+		IChunkable* Chunk,
+		const FIntPoint& ChunkCoord,
+		const TSharedPtr<const FVoxelGenerationSettings>& Settings,
+		const TSharedPtr<FVoxelRegionStore>& Store,
+		const TSharedPtr<FVoxelBakedWorld>& Baked,
+		const TSharedPtr<FVoxelRegionStore>& Cache
+	);
+
+	/**
+	 * Builds the generation settings and opens the generated chunk cache for the current parameters.
+	 */
+	void CreateGenerationSettings();
+
+	/**
+	 * Switches to the current parameters and queues every loaded chunk to be generated again.
+	 */
+	void ApplyGeneratorParams();
+
+	/**
+	 * Regenerates up to Budget queued chunks into spare chunk actors, which replace the
+	   loaded ones once their mesh is ready.
+	 */
+	void ProcessRegeneration(int32 Budget);
+
+	/**
+	 * Shows a regenerated chunk in place of the old one, on the game thread, together with
+	   its collision if the old one had any.
+	 * Drops the result if the chunk was unloaded, edited or the parameters changed again meanwhile.
+	 */
+	void FinishRegeneration(
+		const FVector& ChunkPos,
+		const TWeakObjectPtr<AActor>& StagingActor,
+		const TWeakObjectPtr<AActor>& OldActor,
+		uint32 Epoch,
+		const TSharedPtr<FVoxelCollisionJob>& CollisionJob
+	);
+
+	/**
+	 * Hands the blocks of an edited chunk to the region store before the chunk is reused.
+	 */
+	void SaveChunk(const FVector& ChunkLocation, IChunkable* Chunk);
+
+	/**
+	 * Writes changed regions and cached chunks to disk on a background thread once SaveInterval has passed.
+	 */
+	void TickSave(float DeltaTime);
+
+	/**
+	 * Steps through the grid from block to block along the line with a 3D DDA, until a block
+	   stops it or End is reached. With bOpaqueOnly see-through blocks let the line pass.
+	 */
+	bool TraceBlocks(const FVector& Start, const FVector& End, bool bOpaqueOnly, FVoxelRaycastHit& OutHit) const;
+
+	/**
+	 * Blocks of the loaded chunk at a coordinate, nullptr if it is not loaded or still being generated.
+	 */
+	const TArray<FBlock>* FindChunkBlocks(const FIntPoint& ChunkCoord) const;
+
+	/**
+	 * Coordinate of a chunk in chunk units.
+	 */
+	FIntPoint GetChunkCoord(const FVector& ChunkLocation) const;
+
 	/**
 	 * Spawns a chunk at the specified location in the world.
 	 */
@@ -130,4 +347,9 @@ protected:
 	 * Retrieves the location of the player in the world.
 	 */
 	FVector GetPlayerLocation() const;
+
+	/**
+	 * Coordinates of the chunks the pawns of all players stand in.
+	 */
+	void GetPlayerChunkCoords(TArray<FIntPoint>& OutCoords) const;
 };
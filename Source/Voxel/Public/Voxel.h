@@ -4,3 +4,10 @@
 
 #include "CoreMinimal.h"
 
+
+DECLARE_STATS_GROUP(TEXT("Voxel"), STATGROUP_Voxel, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Chunk Meshing"), STAT_VoxelChunkMeshing, STATGROUP_Voxel, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Chunk Face Data"), STAT_VoxelChunkFaceData, STATGROUP_Voxel, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Chunk Collision"), STAT_VoxelChunkCollision, STATGROUP_Voxel, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Meshed Faces"), STAT_VoxelMeshedFaces, STATGROUP_Voxel, );